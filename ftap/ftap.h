@@ -4,7 +4,11 @@
 #pragma once
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <numeric>
+#include <type_traits>
+#include "include/region.h"
+#include "iter/par.h"
 
 namespace ftap {
 
@@ -46,10 +50,20 @@ namespace ftap {
 		{ }
 	};
 
-	template<class Positions, class Prices>
-	inline value(Positions delta, Prices x) -> std::function<
+	// Delta . X computed in parallel
+	template<class Positions, class Prices,
+		class T = std::common_type_t<
+			typename std::iterator_traits<decltype(std::begin(std::declval<const Positions&>()))>::value_type,
+			typename std::iterator_traits<decltype(std::begin(std::declval<const Prices&>()))>::value_type
+		>
+	>
+	inline T value(const Positions& delta, const Prices& x)
 	{
-		return std::inner_product(std::begin(delta), std::end(delta), std::begin(x), 0);
+		REGION("ftap::value");
+
+		size_t n = std::distance(std::begin(delta), std::end(delta));
+
+		return iter::par::inner_product(iter::ce(std::begin(delta), n), iter::ce(std::begin(x), n), T(0));
 	}
 /*
 	template<class Model>
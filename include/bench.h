@@ -0,0 +1,249 @@
+// bench.h - micro benchmarks
+// auto s = bench::run(f, n) times calls to f() that each compute n values.
+// After warm up calls it finds how many calls take at least sample_ns and
+// times that many calls per sample. Statistics over the samples are in
+// nanoseconds, and time stamp counter cycles, per value.
+// Call bench::keep(x) in f so the optimizer can not discard x.
+// bench::report(name, f, n) runs f and prints one line, or CSV after
+// bench::init(argc, argv) sees --csv. Other arguments select names containing them.
+// bench::run_threads(t, f, n) times t threads started once and released
+// together for each sample, as for contention on shared data.
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "timer.h"
+
+namespace bench {
+
+	// the value of t must be computed
+	template<class T>
+	inline void keep(const T& t)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(t) : "memory");
+#else
+		static volatile const void* p;
+		p = &t;
+		_ReadWriteBarrier();
+#endif
+	}
+
+	struct options {
+		size_t warmup = 3; // untimed calls
+		size_t samples = 31;
+		double sample_ns = 2e5; // minimum time of a sample
+	};
+
+	// per value statistics over samples
+	struct stats {
+		size_t n, samples, calls; // values per call, samples, calls per sample
+		double min, p10, median, p90, max; // nanoseconds
+		double cycles; // median, 0 if not available
+	};
+
+	// nearest rank in sorted t
+	inline double percentile(const std::vector<double>& t, double p)
+	{
+		return t.empty() ? 0 : t[static_cast<size_t>(p*(t.size() - 1) + 0.5)];
+	}
+
+	template<class F>
+	inline stats run(const F& f, size_t n = 1, const options& o = options{})
+	{
+		using std::chrono::nanoseconds;
+
+		for (size_t k = 0; k < o.warmup; ++k)
+			f();
+
+		size_t m = 1;
+		while (m < (size_t(1) << 30) && double(timer::time<nanoseconds>(f, m).count()) < o.sample_ns)
+			m *= 2;
+
+		std::vector<double> t(o.samples), c(o.samples);
+		for (size_t k = 0; k < o.samples; ++k) {
+			uint64_t c0 = timer::cycles();
+			auto d = timer::time<nanoseconds>(f, m);
+			c[k] = double(timer::cycles() - c0)/(m*n);
+			t[k] = double(d.count())/(m*n);
+		}
+		std::sort(t.begin(), t.end());
+		std::sort(c.begin(), c.end());
+
+		return stats{n, o.samples, m, percentile(t, 0), percentile(t, 0.1), percentile(t, 0.5), percentile(t, 0.9), percentile(t, 1), percentile(c, 0.5)};
+	}
+
+	// t threads each make the calls of a sample after a common release
+	// a sample is from the first start to the last finish over the values of all threads
+	template<class F>
+	inline stats run_threads(size_t t, const F& f, size_t n = 1, const options& o = options{})
+	{
+		using std::chrono::nanoseconds;
+		typedef std::chrono::steady_clock clock;
+
+		for (size_t k = 0; k < o.warmup; ++k)
+			f();
+
+		size_t m = 1;
+		while (m < (size_t(1) << 30) && double(timer::time<nanoseconds>(f, m).count()) < o.sample_ns)
+			m *= 2;
+
+		std::mutex mx;
+		std::condition_variable go, done;
+		size_t round = 0, busy = 0;
+		std::vector<clock::time_point> tb(t), te(t);
+		std::vector<uint64_t> cb(t), ce(t);
+		std::vector<std::thread> ts;
+		for (size_t i = 0; i < t; ++i) {
+			ts.emplace_back([&,i]() {
+				for (size_t r = 1; r <= o.samples; ++r) {
+					{
+						std::unique_lock<std::mutex> l(mx);
+						go.wait(l, [&round,r]() { return round >= r; });
+					}
+					cb[i] = timer::cycles();
+					tb[i] = clock::now();
+					for (size_t k = 0; k < m; ++k)
+						f();
+					te[i] = clock::now();
+					ce[i] = timer::cycles();
+
+					std::lock_guard<std::mutex> l(mx);
+					if (--busy == 0)
+						done.notify_one();
+				}
+			});
+		}
+
+		std::vector<double> ns(o.samples), c(o.samples);
+		for (size_t k = 0; k < o.samples; ++k) {
+			{
+				std::unique_lock<std::mutex> l(mx);
+				busy = t;
+				++round;
+				go.notify_all();
+				done.wait(l, [&busy]() { return busy == 0; });
+			}
+			auto d = *std::max_element(te.begin(), te.end()) - *std::min_element(tb.begin(), tb.end());
+			ns[k] = double(std::chrono::duration_cast<nanoseconds>(d).count())/(m*n*t);
+			c[k] = double(*std::max_element(ce.begin(), ce.end()) - *std::min_element(cb.begin(), cb.end()))/(m*n*t);
+		}
+		for (auto& th : ts)
+			th.join();
+		std::sort(ns.begin(), ns.end());
+		std::sort(c.begin(), c.end());
+
+		return stats{n*t, o.samples, m, percentile(ns, 0), percentile(ns, 0.1), percentile(ns, 0.5), percentile(ns, 0.9), percentile(ns, 1), percentile(c, 0.5)};
+	}
+
+	// command line settings
+	struct settings {
+		bool csv = false;
+		std::vector<const char*> names; // run only names containing one of these
+		options o;
+	};
+	inline settings& config()
+	{
+		static settings s;
+
+		return s;
+	}
+
+	// --csv, --quick for fewer samples, or parts of names to run
+	inline void init(int argc, char* argv[])
+	{
+		auto& s = config();
+
+		for (int k = 1; k < argc; ++k) {
+			if (0 == strcmp(argv[k], "--csv")) {
+				s.csv = true;
+			}
+			else if (0 == strcmp(argv[k], "--quick")) {
+				s.o.warmup = 1;
+				s.o.samples = 5;
+				s.o.sample_ns = 2e4;
+			}
+			else {
+				s.names.push_back(argv[k]);
+			}
+		}
+	}
+
+	inline bool selected(const char* name)
+	{
+		const auto& s = config();
+
+		return s.names.empty() || std::any_of(s.names.begin(), s.names.end(),
+			[name](const char* t) { return nullptr != strstr(name, t); });
+	}
+
+	inline void print(const char* name, const stats& s, FILE* os = stdout)
+	{
+		static bool header = false;
+
+		if (config().csv) {
+			if (!header) {
+				fprintf(os, "name,n,samples,calls,min_ns,p10_ns,median_ns,p90_ns,max_ns,median_cycles\n");
+				header = true;
+			}
+			fprintf(os, "\"%s\",%zu,%zu,%zu,%.4g,%.4g,%.4g,%.4g,%.4g,%.4g\n", name,
+				s.n, s.samples, s.calls, s.min, s.p10, s.median, s.p90, s.max, s.cycles);
+		}
+		else {
+			fprintf(os, "%-32s %10.2f ns [%.2f, %.2f] %10.1f cycles\n", name, s.median, s.p10, s.p90, s.cycles);
+		}
+		fflush(os);
+	}
+
+	// run and print if selected
+	template<class F>
+	inline void report(const char* name, const F& f, size_t n = 1)
+	{
+		if (selected(name))
+			print(name, run(f, n, config().o));
+	}
+	template<class F>
+	inline void report_threads(const char* name, size_t t, const F& f, size_t n = 1)
+	{
+		if (selected(name))
+			print(name, run_threads(t, f, n, config().o));
+	}
+
+} // bench
+
+#ifdef _DEBUG
+#include <atomic>
+#include "ensure.h"
+
+inline void test_bench()
+{
+	std::vector<double> t{1, 2, 3, 4, 5};
+	ensure (bench::percentile(t, 0) == 1);
+	ensure (bench::percentile(t, 0.5) == 3);
+	ensure (bench::percentile(t, 1) == 5);
+
+	bench::options o;
+	o.samples = 5;
+	o.sample_ns = 1e4;
+	double x = 0;
+	auto s = bench::run([&x]() { x += 1; bench::keep(x); }, 10, o);
+	ensure (s.n == 10 && s.samples == 5 && s.calls >= 1);
+	ensure (s.min <= s.p10 && s.p10 <= s.median && s.median <= s.p90 && s.p90 <= s.max);
+	ensure (x >= o.warmup + s.samples*s.calls);
+
+	std::atomic<size_t> y(0);
+	auto st = bench::run_threads(3, [&y]() { ++y; }, 2, o);
+	ensure (st.n == 6 && st.samples == 5 && st.calls >= 1);
+	ensure (st.min <= st.median && st.median <= st.max);
+	ensure (y >= o.warmup + 3*st.samples*st.calls);
+
+	ensure (bench::selected("anything"));
+}
+
+#endif // _DEBUG
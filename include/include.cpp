@@ -1,10 +1,14 @@
 // include.cpp - test include files
 #include <iostream>
+#include "bench.h"
+#include "region.h"
 #include "timer.h"
 
 int main()
 {
 	try {
+		test_bench();
+		test_region();
 		test_timer();
 	}
 	catch (const std::exception& ex) {
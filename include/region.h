@@ -0,0 +1,228 @@
+// region.h - count calls and cycles spent in named regions of code
+// { REGION("normal::cdf"); ... } adds one call and the time stamp counter
+// cycles to the end of the scope to a slot owned by the calling thread.
+// Nested regions are inclusive. Recording takes no locks, only registering
+// a name or a new thread does.
+// region::report() sums the slots of all threads, including finished ones.
+// Regions cost two counter reads and are (void)0 unless
+// #define REGION_ENABLE
+// before including. NREGION turns them off again, as it does iter::probe.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "timer.h"
+
+namespace region {
+
+	// maximum number of names
+	static const size_t max = 256;
+
+	// a += n by the only thread writing a, without a locked instruction
+	inline void add(std::atomic<uint64_t>& a, uint64_t n)
+	{
+		a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+
+	// written only by the owning thread, read by report
+	struct counter {
+		std::atomic<uint64_t> calls, cycles;
+
+		counter()
+			: calls(0), cycles(0)
+		{ }
+		void add(uint64_t c)
+		{
+			region::add(calls, 1);
+			region::add(cycles, c);
+		}
+	};
+	// names and per thread slots of C for each name
+	template<class C>
+	class registry_ {
+		struct slots {
+			C c[max];
+		};
+		std::mutex m;
+		std::vector<const char*> names;
+		std::vector<std::unique_ptr<slots>> threads;
+	public:
+		// index of name, same for equal strings
+		size_t id(const char* name)
+		{
+			std::lock_guard<std::mutex> lock(m);
+
+			auto i = std::find_if(names.begin(), names.end(), [name](const char* s) { return 0 == strcmp(s, name); });
+			if (i != names.end())
+				return i - names.begin();
+			if (names.size() == max)
+				throw std::length_error("region::id: too many names");
+			names.push_back(name);
+
+			return names.size() - 1;
+		}
+		// slots for a new thread
+		C* add()
+		{
+			std::lock_guard<std::mutex> lock(m);
+
+			threads.emplace_back(new slots);
+
+			return threads.back()->c;
+		}
+		// V{name} for each name with f(v, c) called for the slot c of every thread
+		template<class V, class F>
+		std::vector<V> sum(F f)
+		{
+			std::lock_guard<std::mutex> lock(m);
+			std::vector<V> v;
+
+			for (size_t k = 0; k < names.size(); ++k) {
+				v.push_back(V{names[k]});
+				for (const auto& t : threads)
+					f(v.back(), t->c[k]);
+			}
+
+			return v;
+		}
+		// r(c) for every slot
+		template<class R>
+		void reset(R r)
+		{
+			std::lock_guard<std::mutex> lock(m);
+
+			for (const auto& t : threads)
+				for (auto& c : t->c)
+					r(c);
+		}
+	};
+	typedef registry_<counter> registry;
+
+	inline registry& global()
+	{
+		static registry r;
+
+		return r;
+	}
+
+	inline size_t id(const char* name)
+	{
+		return global().id(name);
+	}
+	// slots of the calling thread
+	inline counter* local()
+	{
+		thread_local counter* c = global().add();
+
+		return c;
+	}
+
+	// record from construction to destruction
+	class scope_ {
+		counter& c;
+		uint64_t b;
+	public:
+		scope_(size_t id)
+			: c(local()[id]), b(timer::cycles())
+		{ }
+		scope_(const scope_&) = delete;
+		scope_& operator=(const scope_&) = delete;
+		~scope_()
+		{
+			c.add(timer::cycles() - b);
+		}
+	};
+
+	struct total {
+		const char* name;
+		uint64_t calls, cycles;
+	};
+	// totals over all threads, most cycles first
+	inline std::vector<total> totals()
+	{
+		auto t = global().sum<total>([](total& s, const counter& c) {
+			s.calls += c.calls.load(std::memory_order_relaxed);
+			s.cycles += c.cycles.load(std::memory_order_relaxed);
+		});
+		std::stable_sort(t.begin(), t.end(), [](const total& a, const total& b) { return a.cycles > b.cycles; });
+
+		return t;
+	}
+	inline void report(FILE* os = stdout)
+	{
+		fprintf(os, "%-32s %14s %16s %12s\n", "region", "calls", "cycles", "cycles/call");
+		for (const auto& t : totals())
+			fprintf(os, "%-32s %14llu %16llu %12.1f\n", t.name, (unsigned long long)t.calls, (unsigned long long)t.cycles,
+				t.calls ? double(t.cycles)/t.calls : 0.);
+	}
+	inline void reset()
+	{
+		global().reset([](counter& c) {
+			c.calls.store(0, std::memory_order_relaxed);
+			c.cycles.store(0, std::memory_order_relaxed);
+		});
+	}
+
+} // region
+
+#define REGION_CAT_(a, b) a##b
+#define REGION_CAT(a, b) REGION_CAT_(a, b)
+#if defined(REGION_ENABLE) && !defined(NREGION)
+// name must be a string that outlives the program, e.g., a literal
+#define REGION(name) static const size_t REGION_CAT(region_id_, __LINE__) = region::id(name); \
+	region::scope_ REGION_CAT(region_scope_, __LINE__)(REGION_CAT(region_id_, __LINE__))
+#else
+#define REGION(name) (void)0
+#endif
+
+#ifdef _DEBUG
+#include <thread>
+#include "ensure.h"
+
+inline void test_region_work(size_t n)
+{
+	for (size_t k = 0; k < n; ++k) {
+		REGION("test_region inner");
+	}
+}
+
+inline void test_region()
+{
+	ensure (region::id("test_region a") == region::id("test_region a"));
+	ensure (region::id("test_region a") != region::id("test_region b"));
+
+	{
+		REGION("test_region outer");
+		test_region_work(10);
+	}
+	std::thread t([]() { test_region_work(5); });
+	t.join();
+
+	uint64_t inner = 0, outer = 0, outer_cycles = 0;
+	for (const auto& r : region::totals()) {
+		if (0 == strcmp(r.name, "test_region inner"))
+			inner = r.calls;
+		if (0 == strcmp(r.name, "test_region outer")) {
+			outer = r.calls;
+			outer_cycles = r.cycles;
+		}
+	}
+	ensure (outer == 0 || timer::cycles() == 0 || outer_cycles > 0);
+#if defined(REGION_ENABLE) && !defined(NREGION)
+	ensure (inner == 15 && outer == 1);
+#else
+	ensure (inner == 0 && outer == 0);
+#endif
+
+	region::reset();
+	for (const auto& r : region::totals())
+		ensure (r.calls == 0 && r.cycles == 0);
+}
+
+#endif // _DEBUG
@@ -1,20 +1,37 @@
 // timer.h - timing functions
 #pragma once
 #include <chrono>
+#include <cstdint>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 namespace timer {
 
-	template<class F>
-	inline std::chrono::milliseconds time(const F& f, size_t n = 1)
+	// time of n calls to f, e.g., time<std::chrono::nanoseconds>(f, n)
+	template<class D = std::chrono::milliseconds, class F>
+	inline D time(const F& f, size_t n = 1)
 	{
 		using namespace std::chrono;
 
-		auto b = high_resolution_clock::now();
+		auto b = steady_clock::now();
 		while (n--)
 			f();
-		auto e = high_resolution_clock::now();
+		auto e = steady_clock::now();
+
+		return duration_cast<D>(e - b);
+	}
 
-		return duration_cast<milliseconds>(e - b);
+	// time stamp counter, 0 if not available
+	inline uint64_t cycles()
+	{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return 0;
+#endif
 	}
 
 } // timer
@@ -23,27 +40,25 @@ namespace timer {
 #include <thread>
 #include "ensure.h"
 
-#ifdef _WIN32
-extern "C" void __stdcall Sleep(unsigned long);
-#define sleep Sleep
-#endif
-
 inline void test_timer()
 {
 	using namespace std::chrono;
 
 	auto 
-	d = timer::time([]() { Sleep(10); });
+	d = timer::time([]() { std::this_thread::sleep_for(milliseconds(10)); });
 	ensure (d.count() >= 10);
 	ensure (d.count() - 10 < 10);
 
-	d = timer::time([]() { Sleep(100); });
+	d = timer::time([]() { std::this_thread::sleep_for(milliseconds(100)); });
 	ensure (d.count() >= 100);
 	ensure (d.count() - 100 < 10);
 
-	d = timer::time([]() { Sleep(10); }, 10);
+	d = timer::time([]() { std::this_thread::sleep_for(milliseconds(10)); }, 10);
 	ensure (d.count() >= 100);
 	ensure (d.count() - 100 < 60);
+
+	auto ns = timer::time<nanoseconds>([]() { std::this_thread::sleep_for(milliseconds(1)); });
+	ensure (ns.count() >= 1000000);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -4,26 +4,29 @@
 #include <algorithm>
 #include <iterator>
 #include <type_traits>
+#include "callable.h"
+#include "summation.h"
 #include "enumerator/counted.h"
 
 namespace iter {
 
 	// o(t,i[0]), o(o(t,i[0]), i[1]), ...
+	// the state t has type A, e.g., a summation policy, and converts to T
 	template<class O, class I, 
 		class T = typename std::iterator_traits<I>::value_type,
-		class C = typename std::iterator_traits<I>::interator_category
+		class C = typename std::iterator_traits<I>::iterator_category,
+		class A = T
 	>
 	class accumulate_ : public enumerator<I,T,C> {
-//		O o;
-		std::function<T(const T&,const T&)> o;
-		T t;
+		detail::callable<O> o;
+		A t;
 	public:
 		using enumerator<I,T,C>::i;
 		typedef typename enumerator_traits<I>::is_counted is_counted;
 
 		accumulate_()
 		{ }
-		accumulate_(O o, I i, T t)
+		accumulate_(O o, I i, A t)
 			: enumerator<I,T,C>(i), o(o), t(i ? o(t,*i) : t)
 		{ }
 
@@ -41,8 +44,8 @@ namespace iter {
 		}
 		accumulate_& operator++()
 		{
-			if (i)
-				t = o(t, *++i);
+			if (i && ++i)
+				t = o(t, *i);
 
 			return *this;
 		}
@@ -74,6 +77,16 @@ namespace iter {
 		return accumulate_<std::plus<T>,I,T,C>(std::plus<T>{}, i, t);
 	}
 
+	// running sum using summation policy S, e.g., sum<summation::kahan>(i)
+	template<template<class> class S, class I, 
+		class T = typename std::iterator_traits<I>::value_type,
+		class C = typename std::iterator_traits<I>::iterator_category
+	>
+	inline auto sum(I i, T t = T(0))
+	{
+		return accumulate_<summation::plus<S<T>>,I,T,C,S<T>>(summation::plus<S<T>>{}, i, S<T>(t));
+	}
+
 	// running product of  enumerator values
 	template<class I, 
 		class T = typename std::iterator_traits<I>::value_type,
@@ -110,6 +123,23 @@ inline void test_accumulate()
 		ensure (*++b == 6);
 		ensure (!++b);
 	}
+	{
+		auto b = sum<summation::neumaier>(ce(a,3));
+		auto c(b);
+		b = c;
+		ensure (*b++ == 1);
+		ensure (*b == 3);
+		ensure (*++b == 6);
+		ensure (!++b);
+
+		double x[] = {1, 1e100, 1, -1e100};
+		auto d = sum(ce(x));
+		auto e = sum<summation::neumaier>(ce(x));
+		for (int k = 0; k < 3; ++k, ++d, ++e)
+			;
+		ensure (*d == 0);
+		ensure (*e == 2);
+	}
 	{	
 		auto b = prod(ce(a,3));
 		auto c(b);
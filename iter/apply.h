@@ -1,6 +1,8 @@
 // apply.h - apply a function to enumerator values
 #pragma once
 #include <functional>
+#include "block.h"
+#include "callable.h"
 #include "enumerator.h"
 #include "iota.h"
 
@@ -13,10 +15,11 @@ namespace iter {
 		class C = typename std::iterator_traits<I>::iterator_category
 	>
 	class apply_ : public enumerator<I,U,C> {
-		std::function<U(T)> f;
+		detail::callable<F> f;
 	public:
 //		typedef U value_type;
 		using enumerator<I,U,C>::i;
+		typedef block::is_fillable<I> is_fillable;
 
 		apply_()
 		{ }
@@ -24,6 +27,23 @@ namespace iter {
 			: enumerator<I,U,C>(i), f(f)
 		{ }
 
+		size_t extent() const
+		{
+			return block::extent(i);
+		}
+		template<class V>
+		void fill(V* b, size_t n)
+		{
+			T t[block::size];
+
+			for (size_t k = 0; k < n; k += block::size) {
+				size_t m = std::min(n - k, block::size);
+				auto t_ = block::view(i, t, m);
+				for (size_t j = 0; j < m; ++j)
+					b[k + j] = f(t_[j]);
+			}
+		}
+
 		operator bool() const
 		{
 			return i;
@@ -102,6 +122,24 @@ inline void test_apply()
 		ensure (*i++ == exp(1));
 		ensure (*i++ == exp(2));
 	}
+	{
+		int b[3];
+		auto i = apply(f, ce(a, 3));
+		ensure (i.extent() == 3);
+		i.fill(b, 2);
+		ensure (b[0] == f(0) && b[1] == f(1));
+		ensure (*i == f(2));
+	}
+	{
+		// mutable lambdas keep their state
+		int k = 0;
+		auto i = apply([k](int x) mutable { return x + k++; }, iota(0));
+		ensure (*i == 0);
+		++i;
+		ensure (*i == 2);
+		++i;
+		ensure (*i == 4);
+	}
 
 }
 
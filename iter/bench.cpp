@@ -0,0 +1,429 @@
+// bench.cpp - time enumerator pipelines against hand-written loops
+// ./bench [--csv] [--quick] [name ...], times are per element
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "include/bench.h"
+#include "include/ensure.h"
+#include "iter.h"
+
+using namespace iter;
+using bench::keep;
+using bench::report;
+
+// 1 + x + x^2/2! + ... until terms no longer matter
+inline double exp_loop(double x)
+{
+	double s = 0, t = 1;
+
+	for (double n = 1; ; ++n) {
+		t *= x/n;
+		if (!(std::isnormal(t) && t + 1 != 1))
+			break;
+		s += t;
+	}
+
+	return 1 + s;
+}
+
+inline double exp_iter(double x)
+{
+	return 1 + sum0(ne(prod(c(x)/iota(1.0))));
+}
+
+inline double sum_loop(const double* p, size_t n)
+{
+	double s = 0;
+
+	for (size_t k = 0; k < n; ++k)
+		s += p[k];
+
+	return s;
+}
+
+inline int gcd(int a, int b)
+{
+	while (b) {
+		int t = a%b;
+		a = b;
+		b = t;
+	}
+
+	return a;
+}
+
+// sum of first elements of the first n coprime pairs
+template<class E>
+inline int coprime(E e, size_t n)
+{
+	int s = 0;
+
+	for (auto w = where([](const auto& p) { return 1 == gcd((*p).first, (*p).second); }, e); n--; ++w)
+		s += (*w).first;
+
+	return s;
+}
+
+inline bool all_loop(const double* p, size_t n)
+{
+	for (size_t k = 0; k < n; ++k)
+		if (0 == p[k])
+			return false;
+
+	return true;
+}
+
+// each adaptor against the loop it replaces on n elements
+inline void adaptors(size_t n)
+{
+	std::vector<double> a(n), b(n), z(n, 1.);
+	for (size_t k = 0; k < n; ++k) {
+		a[k] = double(k)/n; // increasing in [0, 1)
+		b[k] = 1 + 1e-6*double(k%7);
+	}
+	z.back() = 0;
+	const double* p = a.data();
+	const double* q = b.data();
+	const double x = 0.999;
+
+	report("ce loop", [=]() { keep(sum_loop(p, n)); }, n);
+	report("ce sum0(ce)", [=]() { keep(sum0(ce(p, n))); }, n);
+	report("ee sum0(ee)", [=]() { keep(sum0(ee(p, p + n))); }, n);
+	report("ne loop", [&z]() {
+		double s = 0;
+		for (const double* r = z.data(); *r; ++r)
+			s += *r;
+		keep(s);
+	}, n);
+	report("ne sum0(ne)", [&z]() { keep(sum0(ne(z.data()))); }, n);
+	report("re loop", [=]() {
+		double s = 0;
+		for (size_t k = n; k--; )
+			s += p[k];
+		keep(s);
+	}, n);
+	report("re sum0(ce(re))", [=]() { keep(sum0(ce(re(p + n), n))); }, n);
+
+	report("iota loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += double(k);
+		keep(s);
+	}, n);
+	report("iota sum0(take(iota))", [=]() { keep(sum0(take(n, iota(0.)))); }, n);
+	report("constant loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += x;
+		keep(s);
+	}, n);
+	report("constant sum0(take(c))", [=]() { keep(sum0(take(n, c(x)))); }, n);
+	report("pow loop", [=]() {
+		double s = 0, t = 1;
+		for (size_t k = 0; k < n; ++k, t *= x)
+			s += t;
+		keep(s);
+	}, n);
+	report("pow sum0(take(pow))", [=]() { keep(sum0(take(n, pow(x)))); }, n);
+	report("factorial loop", []() {
+		double s = 0, t = 1;
+		for (size_t k = 0; k < 20; ++k, t /= k)
+			s += t;
+		keep(s);
+	}, 20);
+	report("factorial sum0(take(c/factorial))", []() { keep(sum0(take(20, c(1.)/factorial<double>()))); }, 20);
+	report("choose loop", []() {
+		double s = 0, t = 1;
+		for (double k = 0; k <= 30; ++k) {
+			s += t;
+			t = t*(30 - k)/(k + 1);
+		}
+		keep(s);
+	}, 31);
+	report("choose sum0(choose)", []() { keep(sum0(choose(30.))); }, 31);
+
+	report("binop loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += p[k]*q[k];
+		keep(s);
+	}, n);
+	report("binop sum0(ce*ce)", [=]() { keep(sum0(ce(p, n)*ce(q, n))); }, n);
+	report("apply loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += p[k]*p[k] + 1;
+		keep(s);
+	}, n);
+	report("apply sum0(apply)", [=]() { keep(sum0(apply([](double t) { return t*t + 1; }, ce(p, n)))); }, n);
+	report("sum loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += p[k];
+		keep(s);
+	}, n);
+	report("sum back(sum)", [=]() { keep(back(sum(ce(p, n)))); }, n);
+	report("prod loop", [=]() {
+		double s = 1;
+		for (size_t k = 0; k < n; ++k)
+			s *= q[k];
+		keep(s);
+	}, n);
+	report("prod back(prod)", [=]() { keep(back(prod(ce(q, n)))); }, n);
+	report("delta loop", [=]() {
+		double s = 0, t = 0;
+		for (size_t k = 0; k < n; ++k) {
+			s += p[k] - t;
+			t = p[k];
+		}
+		keep(s);
+	}, n);
+	report("delta sum0(delta)", [=]() { keep(sum0(delta(ce(p, n)))); }, n);
+	report("pair loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			s += p[k] - q[k];
+		keep(s);
+	}, n);
+	report("pair take(pair)", [=]() {
+		double s = 0;
+		for (auto e = take(n, pair(p, q)); e; ++e)
+			s += (*e).first - (*e).second;
+		keep(s);
+	}, n);
+	report("concatenate loop", [=]() { keep(sum_loop(p, n/2) + sum_loop(p + n/2, n - n/2)); }, n);
+	report("concatenate sum0(concatenate)", [=]() { keep(sum0(concatenate(ce(p, n/2), ce(p + n/2, n - n/2)))); }, n);
+
+	report("skip loop", [=]() {
+		double s = 0;
+		for (size_t k = 2; k < n; k += 2)
+			s += p[k];
+		keep(s);
+	}, n/2);
+	report("skip sum0(skip(c(2)))", [=]() { keep(sum0(skip(c(2), ce(p, n)))); }, n/2);
+	report("where loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < n; ++k)
+			if (p[k] > 0.5)
+				s += p[k];
+		keep(s);
+	}, n);
+	report("where sum0(where)", [=]() { keep(sum0(where([](const auto& i) { return *i > 0.5; }, ce(p, n)))); }, n);
+	report("filter sum0(filter)", [=]() { keep(sum0(filter([](double t) { return t > 0.5; }, ce(p, n)))); }, n);
+	report("until loop", [=]() {
+		size_t k = 0;
+		while (k < n && !(p[k] > 0.9))
+			++k;
+		keep(k);
+	}, n);
+	report("until until", [=]() { keep(*until([](const auto& i) { return *i > 0.9; }, ce(p, n))); }, n);
+	report("all loop", [=]() { keep(all_loop(q, n)); }, n);
+	report("all all(ce)", [=]() { keep(all(ce(q, n))); }, n);
+
+	std::vector<size_t> idx; // increasing
+	for (size_t k = 0; k < n; k += 7)
+		idx.push_back(k);
+	const size_t* pi = idx.data();
+	const size_t m = idx.size();
+	report("pick loop", [=]() {
+		double s = 0;
+		for (size_t k = 0; k < m; ++k)
+			s += p[pi[k]];
+		keep(s);
+	}, m);
+	ensure (sum0(pick(ce(pi, m), ce(p, n))) == sum0(apply([p](size_t k) { return p[k]; }, ce(pi, m))));
+	report("pick sum0(pick)", [=]() { keep(sum0(pick(ce(pi, m), ce(p, n)))); }, m);
+
+	std::vector<double> out(n);
+	double* o = out.data();
+	report("eval_into loop", [=]() {
+		for (size_t k = 0; k < n; ++k)
+			o[k] = (p[k] + q[k])*(p[k] - q[k]) + 0.5*q[k];
+		keep(o[n - 1]);
+	}, n);
+	report("eval_into eval_into", [=]() {
+		eval_into(o, n, (ce(p, n) + ce(q, n))*(ce(p, n) - ce(q, n)) + c(0.5)*ce(q, n));
+		keep(o[n - 1]);
+	}, n);
+
+	// nested enumeration
+	auto l = [](int k) { return level(k); };
+	const size_t np = 10000;
+	report("level loop", [=]() {
+		int s = 0;
+		size_t j = 0;
+		for (int k = 2; j < np; ++k)
+			for (int i = 0; i <= k && j < np; ++i, ++j)
+				s += i;
+		keep(s);
+	}, np);
+	report("level flatten(fmap)", [&l]() {
+		int s = 0;
+		auto e = flatten(fmap(l, iota(2)));
+		for (size_t j = 0; j < np; ++j, ++e)
+			s += (*e).first;
+		keep(s);
+	}, np);
+	report("level flat_map", [&l]() {
+		int s = 0;
+		auto e = flat_map(l, iota(2));
+		for (size_t j = 0; j < np; ++j, ++e)
+			s += (*e).first;
+		keep(s);
+	}, np);
+}
+
+int main(int argc, char* argv[])
+{
+	bench::init(argc, argv);
+
+	adaptors(1000);
+
+	double x = 0.5;
+	ensure (exp_loop(x) == exp_iter(x));
+
+	report("exp loop", [&x]() { keep(exp_loop(x)); });
+	report("exp sum0(ne(prod(...)))", [&x]() { keep(exp_iter(x)); });
+
+	// termination policies, terms and time for 1e-8 relative accuracy
+	for (double y : {0.5, 5., 20.}) {
+		auto t = prod(c(y)/iota(1.0));
+		if (!bench::config().csv)
+			printf("exp(%g) terms machine %zu relative %zu ratio %zu\n", y,
+				series(ne(t)).count, series(ne(t, converge::relative(1e-8))).count,
+				series(ne(t, converge::ratio(1e-8))).count);
+		report("exp ne machine", [y]() { keep(sum0(ne(prod(c(y)/iota(1.0))))); });
+		report("exp ne relative 1e-8", [y]() { keep(sum0(ne(prod(c(y)/iota(1.0)), converge::relative(1e-8)))); });
+	}
+
+	// the same series for several arguments in lanes
+	{
+		double xs[8] = {0.1, 0.5, 1, 1.5, 2, 2.5, 3, 3.5};
+		report("exp 8 scalar", [&xs]() { for (double y : xs) keep(exp_iter(y)); }, 8);
+		report("exp simd<double,4> x2", [&xs]() {
+			for (size_t k = 0; k < 8; k += 4) {
+				auto y = simd<double,4>::load(xs + k);
+				keep((1 + sum0(ne(prod(c(y)/iota(simd<double,4>(1))))))[0]);
+			}
+		}, 8);
+		report("exp simd<double,8>", [&xs]() {
+			auto y = simd<double,8>::load(xs);
+			keep((1 + sum0(ne(prod(c(y)/iota(simd<double,8>(1))))))[0]);
+		}, 8);
+	}
+
+	std::vector<double> v(1000000, 1.);
+	const double* p = v.data();
+	size_t m = v.size();
+
+	report("sum loop 1M", [p,m]() { keep(sum_loop(p, m)); }, m);
+	report("sum0(ce(p,n)) 1M", [p,m]() { keep(sum0(ce(p, m))); }, m);
+	report("all loop 1M", [p,m]() { keep(all_loop(p, m)); }, m);
+	report("all(ce(p,n)) 1M", [p,m]() { keep(all(ce(p, m))); }, m);
+	report("any(ce(p,n)) 1M", [p,m]() { keep(any(ce(p, m))); }, m);
+
+	// summation policies, the counted pointer is stepped so all use the same loop
+	auto v1 = ce(p, m)*c(1.);
+	report("sum0 1M", [&v1]() { keep(sum0(v1)); }, m);
+	report("sum0<plain> 1M", [&v1]() { keep(sum0<summation::plain>(v1)); }, m);
+	report("sum0<kahan> 1M", [&v1]() { keep(sum0<summation::kahan>(v1)); }, m);
+	report("sum0<neumaier> 1M", [&v1]() { keep(sum0<summation::neumaier>(v1)); }, m);
+	report("sum0<pairwise> 1M", [&v1]() { keep(sum0<summation::pairwise>(v1)); }, m);
+
+	std::vector<double> w(m, 2.);
+	const double* q = w.data();
+	auto pipe = [p,q](size_t m) {
+		return ce(p, m)*ce(q, m) + apply([](double x) { return x*x; }, ce(q, m))*c(0.5);
+	};
+	const size_t k = 10000;
+	report("pipeline loop 10K", [p,q]() {
+		double s = 0;
+		for (size_t j = 0; j < k; ++j)
+			s += p[j]*q[j] + q[j]*q[j]*0.5;
+		keep(s);
+	}, k);
+	report("pipeline step 10K", [&pipe]() { keep(detail::sum0(pipe(k), 0., std::false_type{})); }, k);
+	report("pipeline block 10K", [&pipe]() { keep(detail::sum0(pipe(k), 0., std::true_type{})); }, k);
+
+	// filtering at 10%, 50%, and 90% selectivity
+	std::vector<double> u(m);
+	unsigned long r = 1;
+	for (size_t j = 0; j < m; ++j) {
+		r = r*6364136223846793005ul + 1442695040888963407ul;
+		u[j] = double(r >> 11)/double(1ul << 53);
+	}
+	const double* pu = u.data();
+	for (double t : {0.9, 0.5, 0.1}) {
+		char name[32];
+		snprintf(name, sizeof(name), "where 1M %2.0f%%", 100*(1 - t));
+		report(name, [pu,m,t]() {
+			double s = 0;
+			for (auto w = where([t](const auto& i) { return *i > t; }, ce(pu, m)); w; ++w)
+				s += *w;
+			keep(s);
+		}, m);
+		snprintf(name, sizeof(name), "filter 1M %2.0f%%", 100*(1 - t));
+		report(name, [pu,m,t]() {
+			double s = 0;
+			for (auto f = filter([t](double x) { return x > t; }, ce(pu, m)); f; ++f)
+				s += *f;
+			keep(s);
+		}, m);
+	}
+
+	// coprime pairs from nested enumeration
+	auto l = [](int n) { return level(n); };
+	ensure (coprime(flatten(fmap(l, iota(2))), 1000) == coprime(flat_map(l, iota(2)), 1000));
+	report("coprime flatten(fmap) 10K", [&l]() { keep(coprime(flatten(fmap(l, iota(2))), 10000)); }, 10000);
+	report("coprime flat_map 10K", [&l]() { keep(coprime(flat_map(l, iota(2)), 10000)); }, 10000);
+
+	// the same pipeline with every stage probed, then untimed and timed probe overhead
+	auto probed = [&l](size_t n) {
+		return coprime(probe(flatten(probe(fmap(l, probe(iota(2), "coprime iota")), "coprime fmap")), "coprime flatten"), n);
+	};
+	ensure (probed(1000) == coprime(flatten(fmap(l, iota(2))), 1000));
+	probes::reset();
+	report("coprime probed 10K", [&probed]() { keep(probed(10000)); }, 10000);
+	report("sum0(probe(p)) 1K", [p]() { keep(sum0(probe(ce(p, 1000), "sum0 p"))); }, 1000);
+	report("sum0(probe(p, 64)) 1K", [p]() { keep(sum0(probe(ce(p, 1000), "sum0 p timed", 64))); }, 1000);
+	if (!bench::config().csv)
+		probes::report();
+
+	// repeated sweeps over an expensive series
+	auto series = apply([](double x) { return std::exp(-x/1000)*std::sin(x); }, iota(0.));
+	auto memo_series = memo(series);
+	report("sweep 1K recompute", [&series]() { keep(sum0(take(1000, series))); }, 1000);
+	report("sweep 1K memo", [&memo_series]() { keep(sum0(take(1000, memo_series))); }, 1000);
+
+	// elementwise into a buffer
+	std::vector<double> out(k);
+	double* o = out.data();
+	report("elementwise step 10K", [p,q,o]() {
+		auto x = (ce(p, k) + ce(q, k))*(ce(p, k) - ce(q, k)) + c(0.5)*ce(q, k);
+		for (size_t j = 0; j < k; ++j, ++x)
+			o[j] = *x;
+		keep(o[k - 1]);
+	}, k);
+
+	// par scaling, 1 thread is the calling thread only
+	std::vector<double> big(10000000, 1.);
+	auto bp = ce(big.data(), big.size())*ce(big.data(), big.size());
+	report("sum0(p*q) 10M", [&bp]() { keep(sum0(bp)); }, big.size());
+
+	// sparse indices into a large grid jump in constant time
+	std::vector<size_t> idx;
+	for (size_t j = 0; j < big.size(); j += 9973)
+		idx.push_back(j);
+	auto grid = ce(big.data(), big.size());
+	report("sum0(pick(1K, 10M))", [&idx,&grid]() { keep(sum0(pick(ce(idx.data(), idx.size()), grid))); }, idx.size());
+
+	for (size_t t = 1; t <= std::max(1u, std::thread::hardware_concurrency()); t *= 2) {
+		par::pool pt(t - 1);
+		char name[32];
+		snprintf(name, sizeof(name), "par::sum0(p*q) 10M %zut", t);
+		report(name, [&bp,&pt]() { keep(par::sum0(bp, 0., pt)); }, big.size());
+	}
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+// block.h - block at a time evaluation of enumerators
+// An enumerator is fillable if it has typedef std::true_type is_fillable and
+// e.fill(b, n) writes the next n values to b and advances e by n,
+// e.extent() is the number of values remaining, or block::infinite.
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include "kernel.h"
+
+// true during constant evaluation, terminals step instead of filling
+// Compilers without __builtin_is_constant_evaluated (before GCC 9, Clang 9,
+// or MSVC 19.25) define ITER_NO_CONSTANT_EVALUATED and it is false, so
+// sum0, prod1, and back keep their block and kernel paths but are not
+// constexpr. Use step::sum0, step::prod1, and step::back there.
+#ifndef ITER_CONSTANT_EVALUATED
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define ITER_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9
+#define ITER_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define ITER_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#ifndef ITER_CONSTANT_EVALUATED
+#define ITER_CONSTANT_EVALUATED() false
+#define ITER_NO_CONSTANT_EVALUATED
+#endif
+// constexpr for functions that take a kernel path at run time
+#ifdef ITER_NO_CONSTANT_EVALUATED
+#define ITER_CONSTEXPR_KERNEL inline
+#else
+#define ITER_CONSTEXPR_KERNEL constexpr
+#endif
+
+// sum0, prod1, and back use fill when every stage is fillable
+// #define ITER_BLOCK 0
+// before including to turn this off. Stepping an inlined pipeline is
+// as fast as filling 128 bit registers so the default is AVX only.
+#ifndef ITER_BLOCK
+#ifdef ITER_AVX
+#define ITER_BLOCK 1
+#else
+#define ITER_BLOCK 0
+#endif
+#endif
+
+namespace iter {
+
+	namespace block {
+
+		// number of values in temporary buffers
+		static const size_t size = 256;
+		static const size_t infinite = std::numeric_limits<size_t>::max();
+
+		template<class...>
+		struct void_ { typedef void type; };
+
+		template<class E, class = void>
+		struct is_fillable : std::false_type { };
+		template<class E>
+		struct is_fillable<E, typename void_<typename E::is_fillable>::type> : E::is_fillable { };
+		template<class T>
+		struct is_fillable<T*> : std::true_type { };
+
+		// terminals dispatch on this
+		template<class E>
+		struct use : std::integral_constant<bool, ITER_BLOCK && is_fillable<E>::value> { };
+
+		template<class E, class U>
+		inline void fill(E& e, U* b, size_t n)
+		{
+			e.fill(b, n);
+		}
+		template<class T, class U>
+		inline void fill(T*& p, U* b, size_t n)
+		{
+			for (size_t k = 0; k < n; ++k)
+				b[k] = p[k];
+			p += n;
+		}
+
+		// the same value n times
+		template<class T>
+		struct repeat {
+			const T& t;
+			const T& operator[](size_t) const
+			{
+				return t;
+			}
+		};
+
+		// random access to the next n values of e, using b for storage if needed
+		template<class E, class U>
+		inline const U* view(E& e, U* b, size_t n, std::false_type)
+		{
+			fill(e, b, n);
+
+			return b;
+		}
+		template<class E, class U>
+		inline auto view(E& e, U* b, size_t n, std::true_type)
+		{
+			return e.view(b, n);
+		}
+		template<class E, class U, class = void>
+		struct has_view : std::false_type { };
+		template<class E, class U>
+		struct has_view<E, U, typename void_<decltype(std::declval<E&>().view((U*)0, size_t(0)))>::type> : std::true_type { };
+		template<class E, class U>
+		inline auto view(E& e, U* b, size_t n)
+		{
+			return view(e, b, n, has_view<E,U>{});
+		}
+		template<class T>
+		inline const T* view(T*& p, typename std::remove_const<T>::type*, size_t n)
+		{
+			const T* v = p;
+			p += n;
+
+			return v;
+		}
+
+		template<class E>
+		constexpr size_t extent(const E& e)
+		{
+			return e.extent();
+		}
+		template<class T>
+		constexpr size_t extent(T* const&)
+		{
+			return infinite;
+		}
+
+		// true if e can be evaluated a block at a time until it is exhausted
+		template<class E>
+		constexpr bool finite(const E& e, std::true_type)
+		{
+			return extent(e) != infinite;
+		}
+		template<class E>
+		constexpr bool finite(const E&, std::false_type)
+		{
+			return false;
+		}
+		template<class E>
+		constexpr bool finite(const E& e)
+		{
+			return finite(e, is_fillable<E>{});
+		}
+
+		// call f(b, m) on consecutive blocks of m values until e is exhausted
+		template<class E, class F>
+		inline void for_each(E& e, F f)
+		{
+			typename std::iterator_traits<E>::value_type b[size];
+
+			for (size_t n = extent(e); n; ) {
+				size_t m = std::min(n, size);
+				f(view(e, b, m), m);
+				n -= m;
+			}
+		}
+
+	} // block
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+
+inline void test_block()
+{
+	using namespace iter;
+
+	static_assert(block::is_fillable<int*>::value, "pointers are fillable");
+	static_assert(!block::is_fillable<int>::value, "int is not an enumerator");
+
+	int a[] = {1,2,3};
+	double b[3];
+	int* pa = a;
+	block::fill(pa, b, 2);
+	ensure (b[0] == 1 && b[1] == 2);
+	ensure (pa == a + 2);
+	ensure (block::extent(pa) == block::infinite);
+	ensure (!block::finite(pa));
+}
+
+#endif // _DEBUG
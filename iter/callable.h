@@ -0,0 +1,128 @@
+// callable.h - hold a function object by value without type erasure
+#pragma once
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace iter {
+
+	namespace detail {
+
+		// function objects that are already regular, e.g., std::plus<T> or function pointers
+		template<class F, bool = std::is_default_constructible<F>::value && std::is_copy_assignable<F>::value>
+		class callable {
+			mutable F f; // stateful function objects, e.g., mutable lambdas
+		public:
+			callable()
+				: f{}
+			{ }
+			callable(const F& f)
+				: f(f)
+			{ }
+
+			template<class... A>
+			auto operator()(A&&... a) const -> decltype(std::declval<F&>()(std::forward<A>(a)...))
+			{
+				return f(std::forward<A>(a)...);
+			}
+		};
+
+		// lambdas are neither default constructible nor copy assignable
+		template<class F>
+		class callable<F,false> {
+			mutable typename std::aligned_storage<sizeof(F), alignof(F)>::type f;
+			bool b;
+
+			F* get() const
+			{
+				return reinterpret_cast<F*>(&f);
+			}
+			void reset()
+			{
+				if (b)
+					get()->~F();
+				b = false;
+			}
+		public:
+			callable()
+				: b(false)
+			{ }
+			callable(const F& f_)
+				: b(true)
+			{
+				::new (get()) F(f_);
+			}
+			callable(const callable& c)
+				: b(c.b)
+			{
+				if (b)
+					::new (get()) F(*c.get());
+			}
+			callable& operator=(const callable& c)
+			{
+				if (this != &c) {
+					reset();
+					if (c.b) {
+						::new (get()) F(*c.get());
+						b = true;
+					}
+				}
+
+				return *this;
+			}
+			~callable()
+			{
+				reset();
+			}
+
+			template<class... A>
+			auto operator()(A&&... a) const -> decltype(std::declval<F&>()(std::forward<A>(a)...))
+			{
+				return (*get())(std::forward<A>(a)...);
+			}
+		};
+
+	} // detail
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+
+inline void test_callable()
+{
+	using iter::detail::callable;
+
+	{
+		callable<std::plus<int>> p, q(std::plus<int>{});
+		p = q;
+		ensure (p(1,2) == 3);
+	}
+	{
+		int n = 2;
+		auto f = [n](int i) { return n*i; };
+		callable<decltype(f)> g, h(f);
+		ensure (h(3) == 6);
+		g = h;
+		ensure (g(4) == 8);
+		callable<decltype(f)> k(g);
+		ensure (k(5) == 10);
+	}
+	{
+		auto f = [](int i) { return i + 1; };
+		static_assert(!std::is_default_constructible<decltype(f)>::value, "lambdas are not regular");
+		static_assert(std::is_default_constructible<callable<decltype(f)>>::value, "callable is regular");
+		static_assert(std::is_copy_assignable<callable<decltype(f)>>::value, "callable is regular");
+	}
+	{
+		// state lives in each copy
+		int k = 0;
+		auto f = [k](int x) mutable { return x + k++; };
+		callable<decltype(f)> g(f);
+		ensure (g(1) == 1 && g(1) == 2);
+		callable<decltype(f)> h(g);
+		ensure (h(1) == 3 && g(1) == 3);
+	}
+}
+
+#endif // _DEBUG
@@ -10,21 +10,19 @@ namespace iter {
 	class choose_ : public enumerator<void,T,std::input_iterator_tag> {
 		T n, k, nk;
 	public:
-		choose_(T n = 0)
+		constexpr choose_(T n = 0)
 			: n(n), k(0), nk(1)
 		{ }
-		~choose_()
-		{ }
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return k <= n;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return nk;
 		}
-		choose_& operator++()
+		constexpr choose_& operator++()
 		{
 			++k;
 			nk *= (n - k + 1); // works for ints
@@ -32,7 +30,7 @@ namespace iter {
 
 			return *this;
 		}
-		choose_ operator++(int)
+		constexpr choose_ operator++(int)
 		{
 			choose_ c(*this);
 
@@ -42,7 +40,7 @@ namespace iter {
 		}
 	};
 	template<class T>
-	inline auto choose(const T& t)
+	constexpr auto choose(const T& t)
 	{
 		return choose_<T>(t);
 	}
@@ -1,5 +1,6 @@
 // constant.h - constant input iterator
 #pragma once
+#include "block.h"
 #include "enumerator.h"
 
 namespace iter {
@@ -8,36 +9,69 @@ namespace iter {
 	class constant_ : public enumerator<void,T,std::input_iterator_tag> {
 		T t;
 	public:
+		typedef std::true_type is_fillable;
+
 		// defaults so infinite
-		constant_(const T& t = 0)
+		constexpr constant_(const T& t = 0)
 			: t(t)
 		{ }
 
-		operator bool() const
+		size_t extent() const
+		{
+			return block::infinite;
+		}
+		template<class U>
+		void fill(U* b, size_t n)
+		{
+			for (size_t k = 0; k < n; ++k)
+				b[k] = t;
+		}
+		template<class U>
+		block::repeat<T> view(U*, size_t)
+		{
+			return block::repeat<T>{t};
+		}
+
+		constexpr operator bool() const
 		{
 			return true;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return t;
 		}
-		constant_& operator++()
+		constexpr constant_& operator++()
+		{
+			return *this;
+		}
+		constexpr constant_ operator++(int)
 		{
 			return *this;
 		}
-		constant_ operator++(int)
+		constant_& operator+=(std::ptrdiff_t)
 		{
 			return *this;
 		}
+		constant_& operator-=(std::ptrdiff_t)
+		{
+			return *this;
+		}
+		T operator[](std::ptrdiff_t) const
+		{
+			return t;
+		}
 	};
 	template<class T>
-	inline constant_<T> constant(const T& t)
+	struct is_random_access<constant_<T>> : std::true_type { };
+
+	template<class T>
+	constexpr constant_<T> constant(const T& t)
 	{
 		return constant_<T>(t);
 	}
 	// shorthand
 	template<class T>
-	inline constant_<T> c(const T& t)
+	constexpr constant_<T> c(const T& t)
 	{
 		return constant_<T>(t);
 	}
@@ -70,6 +104,14 @@ inline void test_constant()
 
 	auto four = c(4);
 	ensure (*four++ == 4 && *++four == 4);
+
+	double b[2];
+	four.fill(b, 2);
+	ensure (b[0] == 4 && b[1] == 4);
+
+	static_assert(is_random_access<decltype(four)>::value, "constants");
+	four += 5;
+	ensure (*four == 4 && four[3] == 4);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -0,0 +1,339 @@
+// converge.h - termination policies for null enumerators
+// A policy P<T> has done(t), true if the term t should not be taken,
+// step(t), called after t is taken, count(), the number of terms taken,
+// and error(t), an estimate of the sum of the terms from t on.
+// Null enumerators pass T{} to step unless P::uses_term is true.
+// Use with ne(i, p), e.g., sum0(ne(i, converge::relative(1e-8))).
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include "simd.h"
+
+namespace iter {
+
+	namespace detail {
+		template<class T>
+		inline bool operator_bool(const T& t)
+		{
+			return t != 0;
+		}
+		template<>
+		inline bool operator_bool<double>(const double& t)
+		{
+			return std::isnormal(t) && t + 1 != 1;
+		}
+		template<>
+		inline bool operator_bool<float>(const float& t)
+		{
+			return std::isnormal(t) && t + 1.f != 1.f;
+		}
+		template<class T>
+		inline T abs(const T& t)
+		{
+			return t < 0 ? -t : t;
+		}
+		template<class T>
+		inline bool finite(const T& t, std::true_type)
+		{
+			return std::isfinite(t);
+		}
+		template<class T>
+		inline bool finite(const T&, std::false_type)
+		{
+			return true;
+		}
+		// false if t would end a null terminated enumeration
+		template<class T>
+		inline bool finite(const T& t)
+		{
+			return t == t && finite(t, std::is_floating_point<T>{});
+		}
+		// |t| > b for a finite term
+		template<class T>
+		inline bool active(const T& t, const T& b)
+		{
+			return finite(t) && abs(t) > b;
+		}
+		// |t|, or 0 if t is not finite
+		template<class T>
+		inline T magnitude(const T& t)
+		{
+			return finite(t) ? abs(t) : T(0);
+		}
+
+		// lanes converge separately, every lane must be done
+		template<class T, size_t N>
+		inline bool operator_bool(const simd<T,N>& t, std::false_type)
+		{
+			for (size_t k = 0; k < N; ++k)
+				if (operator_bool<T>(t[k]))
+					return true;
+
+			return false;
+		}
+		// compare all lanes at once
+		template<class T, size_t N>
+		inline bool operator_bool(const simd<T,N>& t, std::true_type)
+		{
+			auto a = t.v < 0 ? -t.v : t.v;
+			auto b = (a >= std::numeric_limits<T>::min()) & (a <= std::numeric_limits<T>::max()) & (t.v + 1 != 1);
+			auto c = b[0];
+			for (size_t k = 1; k < N; ++k)
+				c |= b[k];
+
+			return c != 0;
+		}
+		template<class T, size_t N>
+		inline bool operator_bool(const simd<T,N>& t)
+		{
+			return operator_bool(t, typename simd<T,N>::is_vector{});
+		}
+		template<class T, size_t N>
+		inline bool active(const simd<T,N>& t, const simd<T,N>& b)
+		{
+			for (size_t k = 0; k < N; ++k)
+				if (active(t[k], b[k]))
+					return true;
+
+			return false;
+		}
+		template<class T, size_t N>
+		inline simd<T,N> abs(simd<T,N> t)
+		{
+			for (size_t k = 0; k < N; ++k)
+				t[k] = abs(t[k]);
+
+			return t;
+		}
+		template<class T, size_t N>
+		inline simd<T,N> magnitude(simd<T,N> t)
+		{
+			for (size_t k = 0; k < N; ++k)
+				t[k] = magnitude(t[k]);
+
+			return t;
+		}
+	} // detail
+
+	namespace converge {
+
+		// number of terms taken
+		template<class T>
+		class count_ {
+			size_t n;
+		public:
+			typedef std::false_type uses_term;
+
+			count_()
+				: n(0)
+			{ }
+			void step(const T&)
+			{
+				++n;
+			}
+			size_t count() const
+			{
+				return n;
+			}
+		};
+
+		// stop at 0, non normal, or negligible terms
+		template<class T>
+		class machine_ : public count_<T> {
+		public:
+			bool done(const T& t) const
+			{
+				return !detail::operator_bool(t);
+			}
+			T error(const T& t) const
+			{
+				return detail::magnitude(t);
+			}
+		};
+
+		// stop when |t| <= epsilon
+		template<class T>
+		class absolute_ : public count_<T> {
+			T eps;
+		public:
+			absolute_(const T& eps)
+				: eps(eps)
+			{ }
+			bool done(const T& t) const
+			{
+				return !detail::active(t, eps);
+			}
+			T error(const T& t) const
+			{
+				return detail::magnitude(t);
+			}
+		};
+		template<class T>
+		inline absolute_<T> absolute(const T& eps)
+		{
+			return absolute_<T>(eps);
+		}
+
+		// stop when |t| <= epsilon |sum of terms taken|
+		template<class T>
+		class relative_ : public count_<T> {
+			T eps, s;
+		public:
+			typedef std::true_type uses_term;
+
+			relative_(const T& eps)
+				: eps(eps), s(0)
+			{ }
+			bool done(const T& t) const
+			{
+				return !detail::active(t, T(eps*detail::abs(s)));
+			}
+			void step(const T& t)
+			{
+				count_<T>::step(t);
+				s += t;
+			}
+			T error(const T& t) const
+			{
+				return detail::magnitude(t);
+			}
+		};
+		template<class T>
+		inline relative_<T> relative(const T& eps)
+		{
+			return relative_<T>(eps);
+		}
+
+		// stop when the geometric tail |t|/(1 - r), r = |t/t_prev| < 1,
+		// is at most epsilon |sum of terms taken|, scalar T only
+		template<class T>
+		class ratio_ : public count_<T> {
+			T eps, s, t_;
+			// bound on |t| + |t| r + |t| r^2 + ..., infinite if r >= 1
+			T tail(const T& t) const
+			{
+				if (t_ == 0)
+					return std::numeric_limits<T>::infinity();
+				T r = detail::abs(t/t_);
+
+				return r < 1 ? detail::abs(t)/(1 - r) : std::numeric_limits<T>::infinity();
+			}
+		public:
+			typedef std::true_type uses_term;
+
+			ratio_(const T& eps)
+				: eps(eps), s(0), t_(0)
+			{ }
+			bool done(const T& t) const
+			{
+				return !detail::finite(t) || t == 0 || tail(t) <= eps*detail::abs(s);
+			}
+			void step(const T& t)
+			{
+				count_<T>::step(t);
+				s += t;
+				t_ = t;
+			}
+			T error(const T& t) const
+			{
+				if (!detail::finite(t))
+					return T(0);
+				T e = tail(t);
+
+				return e == std::numeric_limits<T>::infinity() ? detail::abs(t) : e;
+			}
+		};
+		template<class T>
+		inline ratio_<T> ratio(const T& eps)
+		{
+			return ratio_<T>(eps);
+		}
+
+		// at most n terms using policy P
+		template<class P>
+		class terms_ : public P {
+			size_t n;
+		public:
+			terms_(size_t n, const P& p)
+				: P(p), n(n)
+			{ }
+			template<class T>
+			bool done(const T& t) const
+			{
+				return P::count() >= n || P::done(t);
+			}
+		};
+		template<class P>
+		inline terms_<P> terms(size_t n, const P& p)
+		{
+			return terms_<P>(n, p);
+		}
+		template<class T = double>
+		inline terms_<machine_<T>> terms(size_t n)
+		{
+			return terms_<machine_<T>>(n, machine_<T>{});
+		}
+
+	} // converge
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+
+inline void test_converge()
+{
+	using namespace iter::converge;
+
+	{
+		machine_<double> p;
+		ensure (!p.done(1e-10));
+		ensure (p.done(1e-17));
+		ensure (p.done(0));
+		ensure (p.done(std::numeric_limits<double>::quiet_NaN()));
+		ensure (p.error(std::numeric_limits<double>::infinity()) == 0);
+	}
+	{
+		auto p = absolute(1e-8);
+		ensure (!p.done(-2e-8));
+		ensure (p.done(-1e-8));
+		ensure (p.error(-1e-9) == 1e-9);
+	}
+	{
+		auto p = relative(0.1);
+		ensure (!p.done(1));
+		p.step(1);
+		p.step(1);
+		ensure (!p.done(0.5));
+		ensure (p.done(0.2));
+		ensure (p.count() == 2);
+	}
+	{
+		auto p = ratio(0.01);
+		ensure (!p.done(1));
+		p.step(1);
+		// 0.5 + 0.25 + ... = 1
+		ensure (!p.done(0.5));
+		p.step(0.5);
+		ensure (p.error(0.25) == 0.5);
+		ensure (!p.done(0.25));
+		ensure (p.done(0.01));
+		// terms not decreasing
+		ensure (!p.done(1));
+		ensure (p.error(1) == 1);
+	}
+	{
+		auto p = terms(2, relative(0.));
+		ensure (!p.done(1.));
+		p.step(1.);
+		ensure (!p.done(1.));
+		p.step(1.);
+		ensure (p.done(1.));
+		ensure (p.count() == 2);
+		ensure (terms(0).done(1.));
+	}
+}
+
+#endif // _DEBUG
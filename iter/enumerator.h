@@ -19,6 +19,23 @@ namespace iter {
 		typedef std::false_type is_counted;
 	};
 
+	namespace detail {
+		template<class...>
+		struct void_ { typedef void type; };
+
+		// enumerators have is_counted
+		template<class I, class = void>
+		struct random_access_iterator
+			: std::is_same<typename std::iterator_traits<I>::iterator_category, std::random_access_iterator_tag>
+		{ };
+		template<class I>
+		struct random_access_iterator<I, typename void_<typename I::is_counted>::type> : std::false_type { };
+	} // detail
+
+	// constant time +=, -=, and [], enumerators specialize this
+	template<class I>
+	struct is_random_access : detail::random_access_iterator<I> { };
+
 	// iterator with operator bool() const
 	template<class I, 
 		class T = typename std::iterator_traits<I>::value_type,
@@ -37,7 +54,7 @@ namespace iter {
 
 		enumerator()
 		{ }
-		enumerator(I i)
+		constexpr enumerator(I i)
 			: i(i)
 		{ }
 
@@ -61,11 +78,11 @@ namespace iter {
 		{
 			return i;
 		}
-		I begin()
+		constexpr I begin()
 		{
 			return i;
 		}
-		const I& begin() const
+		constexpr const I& begin() const
 		{
 			return i;
 		}
@@ -74,21 +91,21 @@ namespace iter {
 			return nullptr;
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return true; // infinite
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return *i;
 		}
-		enumerator& operator++()
+		constexpr enumerator& operator++()
 		{
 			++i;
 
 			return *this;
 		}
-		enumerator operator++(int)
+		constexpr enumerator operator++(int)
 		{
 			enumerator e(*this);
 
@@ -96,14 +113,34 @@ namespace iter {
 
 			return e;
 		}
+		// random access I only
+		constexpr enumerator& operator+=(difference_type n)
+		{
+			i += n;
+
+			return *this;
+		}
+		constexpr enumerator& operator-=(difference_type n)
+		{
+			i -= n;
+
+			return *this;
+		}
+		constexpr T operator[](difference_type n) const
+		{
+			return i[n];
+		}
 	};
+	template<class I, class T, class C>
+	struct is_random_access<enumerator<I,T,C>> : is_random_access<I> { };
+
 	template<class I, class T = typename std::iterator_traits<I>::value_type>
-	inline enumerator<I,T> make_enumerator(I i)
+	constexpr enumerator<I,T> make_enumerator(I i)
 	{
 		return enumerator<I,T>(i);
 	}
 	template<class I, class T = typename std::iterator_traits<I>::value_type>
-	inline enumerator<I,T> e(I i)
+	constexpr enumerator<I,T> e(I i)
 	{
 		return enumerator<I,T>(i);
 	}
@@ -130,7 +167,7 @@ namespace iter {
 
 		enumerator()
 		{ }
-		enumerator(T* i)
+		constexpr enumerator(T* i)
 			: i(i)
 		{ }
 
@@ -154,11 +191,11 @@ namespace iter {
 		{
 			return i;
 		}
-		T* begin()
+		constexpr T* begin()
 		{
 			return i;
 		}
-		const T* begin() const
+		constexpr const T* begin() const
 		{
 			return i;
 		}
@@ -167,21 +204,21 @@ namespace iter {
 			return nullptr;
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return true; // infinite
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return *i;
 		}
-		enumerator& operator++()
+		constexpr enumerator& operator++()
 		{
 			++i;
 
 			return *this;
 		}
-		enumerator operator++(int)
+		constexpr enumerator operator++(int)
 		{
 			enumerator e(*this);
 
@@ -189,13 +226,13 @@ namespace iter {
 
 			return e;
 		}
-		enumerator& operator--()
+		constexpr enumerator& operator--()
 		{
 			--i;
 
 			return *this;
 		}
-		enumerator operator--(int)
+		constexpr enumerator operator--(int)
 		{
 			enumerator e(*this);
 
@@ -203,19 +240,19 @@ namespace iter {
 
 			return e;
 		}
-		enumerator& operator+=(difference_type n)
+		constexpr enumerator& operator+=(difference_type n)
 		{
 			i += n;
 
 			return *this;
 		}
-		enumerator& operator-=(difference_type n)
+		constexpr enumerator& operator-=(difference_type n)
 		{
 			i -= n;
 
 			return *this;
 		}
-		difference_type operator-(const enumerator& j) const
+		constexpr difference_type operator-(const enumerator& j) const
 		{
 			return i - j.i;
 		}
@@ -223,7 +260,7 @@ namespace iter {
 		{
 			return i[n];
 		}
-*/		const T& operator[](difference_type n) const
+*/		constexpr const T& operator[](difference_type n) const
 		{
 			return i[n];
 		}
@@ -244,7 +281,7 @@ namespace iter {
 
 		enumerator()
 		{ }
-		enumerator(const T* i)
+		constexpr enumerator(const T* i)
 			: i(i)
 		{ }
 
@@ -272,11 +309,11 @@ namespace iter {
 		{
 			return i;
 		}
-		T* begin()
+		constexpr T* begin()
 		{
 			return i;
 		}
-		const T* begin() const
+		constexpr const T* begin() const
 		{
 			return i;
 		}
@@ -285,21 +322,21 @@ namespace iter {
 			return nullptr;
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return true; // infinite
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return *i;
 		}
-		enumerator& operator++()
+		constexpr enumerator& operator++()
 		{
 			++i;
 
 			return *this;
 		}
-		enumerator operator++(int)
+		constexpr enumerator operator++(int)
 		{
 			enumerator e(*this);
 
@@ -307,13 +344,13 @@ namespace iter {
 
 			return e;
 		}
-		enumerator& operator--()
+		constexpr enumerator& operator--()
 		{
 			--i;
 
 			return *this;
 		}
-		enumerator operator--(int)
+		constexpr enumerator operator--(int)
 		{
 			enumerator e(*this);
 
@@ -321,19 +358,19 @@ namespace iter {
 
 			return e;
 		}
-		enumerator& operator+=(difference_type n)
+		constexpr enumerator& operator+=(difference_type n)
 		{
 			i += n;
 
 			return *this;
 		}
-		enumerator& operator-=(difference_type n)
+		constexpr enumerator& operator-=(difference_type n)
 		{
 			i -= n;
 
 			return *this;
 		}
-		difference_type operator-(const enumerator& j) const
+		constexpr difference_type operator-(const enumerator& j) const
 		{
 			return i - j.i;
 		}
@@ -341,7 +378,7 @@ namespace iter {
 		{
 			return i[n];
 		}
-*/		const T& operator[](difference_type n) const
+*/		constexpr const T& operator[](difference_type n) const
 		{
 			return i[n];
 		}
@@ -412,6 +449,9 @@ inline void test_enumerator()
 		ensure (d == b);
 
 		ensure (d - b == 0);
+		static_assert(is_random_access<int*>::value, "pointers");
+		static_assert(is_random_access<decltype(d)>::value, "pointer enumerators");
+		ensure (d[1] == 2);
 	}
 	{
 		std::vector<int> a = {1,2,3};
@@ -421,6 +461,11 @@ inline void test_enumerator()
 		b++;
 		ensure (*b == 3);
 		b = a.begin();
+		static_assert(is_random_access<decltype(b)>::value, "vector iterators");
+		b += 2;
+		ensure (*b == 3);
+		b -= 1;
+		ensure (b[1] == 3);
 //		auto c = e(a.end());
 //		ensure (std::distance(b,c) == a.size()); // operator bool() called!!!
 	}
@@ -1,5 +1,6 @@
 // counted.h - enumerators with a count
 #pragma once
+#include "../block.h"
 #include "../enumerator.h"
 
 namespace iter {
@@ -11,21 +12,70 @@ namespace iter {
 	>
 	class counted_enumerator : public enumerator<I,T,C> {
 		size_t n;
+		template<class U>
+		void fill(U* b, size_t m, std::true_type)
+		{
+			block::fill(i, b, m);
+		}
+		template<class U>
+		void fill(U* b, size_t m, std::false_type)
+		{
+			for (size_t k = 0; k < m; ++k, ++i)
+				b[k] = *i;
+		}
+		template<class U>
+		const U* view(U* b, size_t m, U*)
+		{
+			return block::view(i, b, m);
+		}
+		template<class U>
+		const U* view(U* b, size_t m, const U*)
+		{
+			return block::view(i, b, m);
+		}
+		template<class U, class J>
+		const U* view(U* b, size_t m, J)
+		{
+			fill(b, m, block::is_fillable<I>{});
+
+			return b;
+		}
 	public:
 		typedef std::true_type is_counted;
+		typedef std::true_type is_fillable;
 		using enumerator<I,T,C>::i;
 
 		counted_enumerator()
 		{ }
-		counted_enumerator(I i, size_t n)
+		constexpr counted_enumerator(I i, size_t n)
 			: enumerator<I,T,C>(i), n(n)
 		{ }
 
-		size_t size() const
+		constexpr size_t size() const
 		{
 			return n;
 		}
-		I begin()
+		constexpr size_t extent() const
+		{
+			return n;
+		}
+		// m <= size()
+		template<class U>
+		void fill(U* b, size_t m)
+		{
+			fill(b, m, block::is_fillable<I>{});
+			n -= m;
+		}
+		// contiguous values are not copied
+		template<class U>
+		const U* view(U* b, size_t m)
+		{
+			const U* v = view(b, m, i);
+			n -= m;
+
+			return v;
+		}
+		constexpr I begin()
 		{
 			return i;
 		}
@@ -38,22 +88,22 @@ namespace iter {
 			return e;
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return n != 0;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return *i;
 		}
-		counted_enumerator& operator++()
+		constexpr counted_enumerator& operator++()
 		{
 			++i;
 			--n;
 
 			return *this;
 		}
-		counted_enumerator operator++(int)
+		constexpr counted_enumerator operator++(int)
 		{
 			counted_enumerator e(*this);
 
@@ -61,15 +111,36 @@ namespace iter {
 
 			return e;
 		}
+		// random access I only, moves at most size() forward
+		constexpr counted_enumerator& operator+=(std::ptrdiff_t m)
+		{
+			if (m > 0 && static_cast<size_t>(m) > n)
+				m = n;
+			i += m;
+			n -= m;
+
+			return *this;
+		}
+		constexpr counted_enumerator& operator-=(std::ptrdiff_t m)
+		{
+			return operator+=(-m);
+		}
+		constexpr T operator[](std::ptrdiff_t m) const
+		{
+			return i[m];
+		}
 	};
+	template<class I, class T, class C>
+	struct is_random_access<counted_enumerator<I,T,C>> : is_random_access<I> { };
+
 	template<class I, class T = typename std::iterator_traits<I>::value_type>
-	inline counted_enumerator<I,T> make_counted_enumerator(I i, size_t n)
+	constexpr counted_enumerator<I,T> make_counted_enumerator(I i, size_t n)
 	{
 		return counted_enumerator<I,T>(i, n);
 	}
 	// shorthand
 	template<class I, class T = typename std::iterator_traits<I>::value_type>
-	inline counted_enumerator<I,T> ce(I i, size_t n)
+	constexpr counted_enumerator<I,T> ce(I i, size_t n)
 	{
 		return counted_enumerator<I,T>(i, n);
 	}
@@ -84,11 +155,11 @@ namespace iter {
 
 		counted_enumerator()
 		{ }
-		counted_enumerator(T(&i)[N])
+		constexpr counted_enumerator(T(&i)[N])
 			: enumerator<T*,T,std::random_access_iterator_tag>(i), n(N)
 		{ }
 
-		size_t size() const
+		constexpr size_t size() const
 		{
 			return n;
 		}
@@ -101,22 +172,22 @@ namespace iter {
 			return e;
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return n != 0;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return *i;
 		}
-		counted_enumerator& operator++()
+		constexpr counted_enumerator& operator++()
 		{
 			++i;
 			--n;
 
 			return *this;
 		}
-		counted_enumerator operator++(int)
+		constexpr counted_enumerator operator++(int)
 		{
 			counted_enumerator e(*this);
 
@@ -124,15 +195,36 @@ namespace iter {
 
 			return e;
 		}
+		// random access I only, moves at most size() forward
+		constexpr counted_enumerator& operator+=(std::ptrdiff_t m)
+		{
+			if (m > 0 && static_cast<size_t>(m) > n)
+				m = n;
+			i += m;
+			n -= m;
+
+			return *this;
+		}
+		constexpr counted_enumerator& operator-=(std::ptrdiff_t m)
+		{
+			return operator+=(-m);
+		}
+		constexpr T operator[](std::ptrdiff_t m) const
+		{
+			return i[m];
+		}
 	};
 	template<class T, size_t N>
-	inline auto make_counted_enumerator(T(&i)[N])
+	struct is_random_access<counted_enumerator<T(&)[N]>> : std::true_type { };
+
+	template<class T, size_t N>
+	constexpr auto make_counted_enumerator(T(&i)[N])
 	{
 		return make_counted_enumerator(i, N);
 	}
 	// shorthand
 	template<class T, size_t N>
-	inline auto ce(T(&i)[N])
+	constexpr auto ce(T(&i)[N])
 	{
 		return make_counted_enumerator(i, N);
 	}
@@ -179,8 +271,33 @@ inline void test_enumerator_counted()
 		ensure (b.end()[-1] == 3);
 		b += 2;
 		ensure (*b == 3);
+		ensure (b.size() == 1);
 		b -= 2;
 		ensure (*b == 1);
+		ensure (b.size() == 3);
+		b += 10;
+		ensure (!b);
+	}
+	{
+		auto b = ce(a, 3);
+		static_assert(is_random_access<decltype(b)>::value, "counted pointers");
+		ensure (b[2] == 3);
+		b += 1;
+		ensure (b.size() == 2 && b[1] == 3);
+	}
+	{
+		int b[3];
+		auto e = ce(a);
+		ensure (e.extent() == 3);
+		e.fill(b, 2);
+		ensure (b[0] == 1 && b[1] == 2);
+		ensure (e.size() == 1 && *e == 3);
+
+		int n = 0, s = 0;
+		e = ce(a);
+		block::for_each(e, [&n,&s](const int* b, size_t m) { n += (int)m; s += b[0] + b[m-1]; });
+		ensure (n == 3 && s == 1 + 3);
+		ensure (!e);
 	}
 }
 
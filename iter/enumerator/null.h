@@ -2,47 +2,53 @@
 #pragma once
 #include <limits>
 #include <numeric>
+#include "../converge.h"
 #include "../enumerator.h"
 
 namespace iter {
 
-	namespace detail {
-		template<class T>
-		inline bool operator_bool(const T& t)
-		{
-			return t != 0;
-		}
-		template<>
-		inline bool operator_bool<double>(const double& t)
-		{
-			return std::isnormal(t) && t + 1 != 1;
-		}
-		template<>
-		inline bool operator_bool<float>(const float& t)
-		{
-			return std::isnormal(t) && t + 1.f != 1.f;
-		}
-	}
-
 	// null terminated enumerator
+	// P is a termination policy from converge.h
 	template<class I, 
 		class T = typename std::iterator_traits<I>::value_type,
-		class C = typename std::iterator_traits<I>::iterator_category
+		class C = typename std::iterator_traits<I>::iterator_category,
+		class P = converge::machine_<T>
 	>
 	class null_enumerator : public enumerator<I,T,C> {
+		P p;
+		// only evaluate terms the policy uses
+		void step(std::true_type)
+		{
+			p.step(operator*());
+		}
+		void step(std::false_type)
+		{
+			p.step(T{});
+		}
 	public:
 		using enumerator<I,T,C>::i;
 
 		typedef std::false_type is_counted; // for tag dispatch
 		null_enumerator()
 		{ }
-		null_enumerator(I i)
-			: enumerator<I,T,C>(i)
+		null_enumerator(I i, const P& p = P{})
+			: enumerator<I,T,C>(i), p(p)
 		{ }
 
+		// number of terms stepped over
+		size_t count() const
+		{
+			return p.count();
+		}
+		// estimate of the sum of the remaining terms
+		T error() const
+		{
+			return p.error(operator*());
+		}
+
 		operator bool() const
 		{
-			return detail::operator_bool<T>(operator*());
+			return !p.done(operator*());
 		}
 		T operator*() const
 		{
@@ -50,6 +56,7 @@ namespace iter {
 		}
 		null_enumerator& operator++()
 		{
+			step(typename P::uses_term{});
 			++i;
 
 			return *this;
@@ -74,6 +81,31 @@ namespace iter {
 	{
 		return null_enumerator<I,T>(i);
 	}
+	// terminate using policy p, e.g., ne(i, converge::relative(1e-8))
+	template<class I, class P, class T = typename std::iterator_traits<I>::value_type>
+	inline null_enumerator<I,T,typename std::iterator_traits<I>::iterator_category,P> ne(I i, const P& p)
+	{
+		return null_enumerator<I,T,typename std::iterator_traits<I>::iterator_category,P>(i, p);
+	}
+
+	// sum of terms, number of terms, and error estimate
+	template<class T>
+	struct series_ {
+		T sum;
+		size_t count;
+		T error;
+	};
+	// sum a null enumerator reporting convergence
+	template<class I, class T, class C, class P>
+	inline series_<T> series(null_enumerator<I,T,C,P> e, typename std::common_type<T>::type s = T(0))
+	{
+		while (e) {
+			s += *e;
+			++e;
+		}
+
+		return series_<T>{s, e.count(), e.error()};
+	}
 
 } // iter
 
@@ -117,6 +149,23 @@ inline void test_enumerator_null()
 		ensure (1 + std::numeric_limits<double>::epsilon()/2 == 1);
 		ensure (!b);
 	}
+	{
+		double a[] = {1, 0.1, 0.01, 1e-3, 1e-4, 1e-5, 0};
+		auto b = ne(a, converge::absolute(1e-3));
+		auto s = series(b);
+		ensure (s.count == 3);
+		ensure (s.sum == 1 + 0.1 + 0.01);
+		ensure (s.error == 1e-3);
+		s = series(ne(a));
+		ensure (s.count == 6);
+		ensure (s.error == 0);
+		s = series(ne(a, converge::terms(2)), 1);
+		ensure (s.count == 2 && s.sum == 2.1);
+		s = series(ne(a, converge::relative(1e-2)));
+		ensure (s.count == 2);
+		s = series(ne(a, converge::ratio(1e-2)));
+		ensure (s.count == 3 && s.error < 1.2e-3);
+	}
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -32,6 +32,23 @@ namespace iter {
 		{
 			return i;
 		}
+		// random access I only
+		reverse_enumerator& operator+=(std::ptrdiff_t n)
+		{
+			i += n;
+
+			return *this;
+		}
+		reverse_enumerator& operator-=(std::ptrdiff_t n)
+		{
+			i -= n;
+
+			return *this;
+		}
+		T operator[](std::ptrdiff_t n) const
+		{
+			return i[n];
+		}
 
 /*		operator bool() const
 		{
@@ -57,6 +74,9 @@ namespace iter {
 			return r;
 		}
 */	};
+	template<class I, class T, class C>
+	struct is_random_access<reverse_enumerator<I,T,C>> : is_random_access<I> { };
+
 	template<class I, 
 		class T = typename std::iterator_traits<I>::value_type,
 		class C = typename std::iterator_traits<I>::iterator_category
@@ -95,6 +115,14 @@ inline void test_enumerator_reverse()
 	ensure (*++ra == 2);
 	ra++;
 	ensure (*ra == 1);
+
+	auto rc = re(a + 3);
+	static_assert(is_random_access<decltype(rc)>::value, "reverse pointers");
+	ensure (rc[2] == 1);
+	rc += 2;
+	ensure (*rc == 1);
+	rc -= 1;
+	ensure (*rc == 2);
 }
 
 #endif // _DEBUG
\ No newline at end of file
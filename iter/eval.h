@@ -0,0 +1,199 @@
+// eval.h - evaluate expressions into caller provided storage
+// Random access expressions, e.g., a binop tree over pointer, counted, and
+// constant leaves, are indexed so the tree is inlined into a single loop.
+#pragma once
+#include <algorithm>
+#include <type_traits>
+#include "block.h"
+#include "enumerator.h"
+#include "expr.h"
+
+namespace iter {
+
+	namespace detail {
+
+		// values e has left, block::infinite if it does not end
+		template<class E>
+		constexpr size_t bound(const E& e, std::true_type)
+		{
+			return block::extent(e);
+		}
+		template<class E>
+		constexpr size_t bound(const E&, std::false_type)
+		{
+			return block::infinite;
+		}
+		template<class E>
+		constexpr size_t bound(const E& e)
+		{
+			return bound(e, block::is_fillable<E>{});
+		}
+		// a counted leaf ends a tree that is not fillable
+		template<class O, class I, class J, class T, class U, class V, class C>
+		constexpr size_t bound(const binop<O,I,J,T,U,V,C>& e)
+		{
+			return std::min(bound(e.i.first), bound(e.i.second));
+		}
+
+		template<class U, class E>
+		inline U* eval_into(U* out, size_t n, const E& e, std::true_type)
+		{
+			n = std::min(n, bound(e));
+			for (size_t k = 0; k < n; ++k)
+				out[k] = e[k];
+
+			return out + n;
+		}
+		template<class U, class E>
+		inline U* eval_into(U* out, size_t n, E e, std::false_type)
+		{
+			for (; n && e; --n, ++e)
+				*out++ = *e;
+
+			return out;
+		}
+
+	} // detail
+
+	// write at most n values of e to out and return the end of the values written
+	// out must have room for n values
+	template<class U, class E>
+	inline U* eval_into(U* out, size_t n, const E& e)
+	{
+		return detail::eval_into(out, n, e, is_random_access<E>{});
+	}
+
+	// output enumerator over n values at p
+	template<class T>
+	class output_ : public enumerator<T*,T,std::random_access_iterator_tag> {
+		size_t n;
+	public:
+		using enumerator<T*,T,std::random_access_iterator_tag>::i;
+
+		output_(T* p, size_t n)
+			: enumerator<T*,T,std::random_access_iterator_tag>(p), n(n)
+		{ }
+
+		size_t size() const
+		{
+			return n;
+		}
+
+		// overwrite the remaining values with those of e
+		template<class E>
+		output_& assign(const E& e)
+		{
+			eval_into(i, n, e);
+
+			return *this;
+		}
+
+		operator bool() const
+		{
+			return n != 0;
+		}
+		T& operator*()
+		{
+			return *i;
+		}
+		output_& operator++()
+		{
+			++i;
+			--n;
+
+			return *this;
+		}
+		output_ operator++(int)
+		{
+			output_ o(*this);
+
+			operator++();
+
+			return o;
+		}
+	};
+	template<class T>
+	inline output_<T> output(T* p, size_t n)
+	{
+		return output_<T>(p, n);
+	}
+	template<class T, size_t N>
+	inline output_<T> output(T(&a)[N])
+	{
+		return output_<T>(a, N);
+	}
+
+} // iter
+
+#ifdef _DEBUG
+#include <algorithm>
+#include "include/ensure.h"
+#include "constant.h"
+#include "expr.h"
+#include "enumerator/counted.h"
+#include "iota.h"
+#include "take.h"
+
+inline void test_eval()
+{
+	using namespace iter;
+
+	double a[] = {1,2,3,4};
+	double b[4];
+	{
+		auto ai = e(a);
+		static_assert(is_random_access<decltype((ai + ai) + (ai + ai) + ai)>::value, "pointer leaves");
+		ensure (eval_into(b, 4, (ai + ai) + (ai + ai) + ai) == b + 4);
+		for (size_t k = 0; k < 4; ++k)
+			ensure (b[k] == 5*a[k]);
+	}
+	{
+		eval_into(b, 4, ce(a)*c(2.) - a);
+		for (size_t k = 0; k < 4; ++k)
+			ensure (b[k] == a[k]);
+	}
+	{
+		const double* pa = a;
+		static_assert(is_random_access<decltype(ce(pa, 4))>::value, "const pointers");
+		eval_into(b, 4, ce(pa, 4) + ce(pa, 4));
+		ensure (b[3] == 8);
+	}
+	{
+		int n[] = {1,2,3,4};
+		eval_into(b, 4, ce(n, 4)*c(0.5));
+		for (size_t k = 0; k < 4; ++k)
+			ensure (b[k] == n[k]/2.);
+	}
+	{
+		// not indexable, stops at end
+		static_assert(!is_random_access<decltype(ce(a)*iota(0.))>::value, "iota is stepped");
+		std::fill(b, b + 4, 0.);
+		ensure (eval_into(b, 4, take(2, ce(a)*iota(0.))) == b + 2);
+		ensure (b[0] == 0 && b[1] == 2 && b[2] == 0);
+	}
+	{
+		// indexed, stops at the shortest counted leaf
+		double a2[] = {10,20};
+		std::fill(b, b + 4, 0.);
+		ensure (eval_into(b, 4, ce(a2, 2) + ce(a, 4)) == b + 2);
+		ensure (b[0] == 11 && b[1] == 22 && b[2] == 0);
+		ensure (eval_into(b, 4, e(a)*(ce(a2, 1) + e(a))) == b + 1);
+		ensure (b[0] == 11 && b[1] == 22);
+		auto o = output(b);
+		o.assign(ce(a2, 2)*c(2.));
+		ensure (b[0] == 20 && b[1] == 40 && b[2] == 0);
+	}
+	{
+		auto o = output(b);
+		ensure (o.size() == 4);
+		o.assign(e(a)*e(a));
+		ensure (b[3] == 16);
+		*o = 0;
+		++o;
+		o.assign(c(1.));
+		ensure (b[0] == 0 && b[1] == 1 && b[3] == 1);
+		ensure (o.size() == 3);
+	}
+}
+
+#endif // _DEBUG
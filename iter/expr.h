@@ -1,6 +1,7 @@
 // expr.h - iter expressions
 #pragma once
 #include <functional>
+#include "block.h"
 #include "pair.h"
 
 namespace iter {
@@ -18,27 +19,48 @@ namespace iter {
 		O o;
 	public:
 		using enumerator<std::pair<I,J>,V,C>::i;
+		typedef std::integral_constant<bool,
+			block::is_fillable<I>::value && block::is_fillable<J>::value> is_fillable;
 
-		binop(O o, I i, J j)
+		constexpr binop(O o, I i, J j)
 			: enumerator<std::pair<I,J>,V,C>(std::make_pair(i, j)), o(o)
 		{ }
 
-		operator bool() const
+		size_t extent() const
+		{
+			return std::min(block::extent(i.first), block::extent(i.second));
+		}
+		template<class W>
+		void fill(W* b, size_t n)
+		{
+			T t[block::size];
+			U u[block::size];
+
+			for (size_t k = 0; k < n; k += block::size) {
+				size_t m = std::min(n - k, block::size);
+				auto t_ = block::view(i.first, t, m);
+				auto u_ = block::view(i.second, u, m);
+				for (size_t j = 0; j < m; ++j)
+					b[k + j] = o(t_[j], u_[j]);
+			}
+		}
+
+		constexpr operator bool() const
 		{
 			return i.first && i.second;
 		}
-		V operator*() const
+		constexpr V operator*() const
 		{
 			return o(*i.first, *i.second);
 		}
-		binop& operator++()
+		constexpr binop& operator++()
 		{
 			++i.first;
 			++i.second;
 
 			return *this;
 		}
-		binop operator++(int)
+		constexpr binop operator++(int)
 		{
 			binop a(*this);
 
@@ -46,7 +68,30 @@ namespace iter {
 
 			return a;
 		}
+		// random access I and J only
+		constexpr binop& operator+=(std::ptrdiff_t n)
+		{
+			i.first += n;
+			i.second += n;
+
+			return *this;
+		}
+		constexpr binop& operator-=(std::ptrdiff_t n)
+		{
+			i.first -= n;
+			i.second -= n;
+
+			return *this;
+		}
+		constexpr V operator[](std::ptrdiff_t n) const
+		{
+			return o(i.first[n], i.second[n]);
+		}
 	};
+	template<class O, class I, class J, class T, class U, class V, class C>
+	struct is_random_access<binop<O,I,J,T,U,V,C>>
+		: std::integral_constant<bool, is_random_access<I>::value && is_random_access<J>::value>
+	{ };
 	template<class O, class I, class J,
 		class T = typename std::iterator_traits<I>::value_type,
 		class U = typename std::iterator_traits<J>::value_type,
@@ -56,7 +101,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto make_binop(O o, I i, J j)
+	constexpr auto make_binop(O o, I i, J j)
 	{
 		return binop<O,I,J,T,U,V,C>(o, i, j);
 	}
@@ -72,7 +117,7 @@ template<class I, class J,
 		typename std::iterator_traits<J>::iterator_category
 	>
 >
-inline auto operator+(I i, J j)
+constexpr auto operator+(I i, J j)
 {
 	return iter::make_binop<std::plus<V>,I,J,T,U,V,C>(std::plus<V>{}, i, j);
 }
@@ -85,7 +130,7 @@ template<class I, class J,
 		typename std::iterator_traits<J>::iterator_category
 	>
 >
-inline auto operator-(I i, J j)
+constexpr auto operator-(I i, J j)
 {
 	return iter::make_binop<std::minus<V>,I,J,T,U,V,C>(std::minus<V>{}, i, j);
 }
@@ -98,7 +143,7 @@ template<class I, class J,
 		typename std::iterator_traits<J>::iterator_category
 	>
 >
-inline auto operator*(I i, J j)
+constexpr auto operator*(I i, J j)
 {
 	return iter::make_binop<std::multiplies<V>,I,J,T,U,V,C>(std::multiplies<V>{}, i, j);
 }
@@ -111,7 +156,7 @@ template<class I, class J,
 		typename std::iterator_traits<J>::iterator_category
 	>
 >
-inline auto operator/(I i, J j)
+constexpr auto operator/(I i, J j)
 {
 	return iter::make_binop<std::divides<V>,I,J,T,U,V,C>(std::divides<V>{}, i, j);
 }
@@ -124,7 +169,7 @@ template<class I, class J,
 		typename std::iterator_traits<J>::iterator_category
 	>
 >
-inline auto operator%(I i, J j)
+constexpr auto operator%(I i, J j)
 {
 	return iter::make_binop<std::modulus<V>,I,J,T,U,V,C>(std::modulus<V>{}, i, j);
 }
@@ -139,7 +184,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto equal_to(I i, J j)
+	constexpr auto equal_to(I i, J j)
 	{
 		return iter::make_binop<std::equal_to<V>,I,J,T,U,bool,C>(std::equal_to<V>{}, i, j);
 	}
@@ -152,7 +197,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto not_equal_to(I i, J j)
+	constexpr auto not_equal_to(I i, J j)
 	{
 		return iter::make_binop<std::not_equal_to<V>,I,J,T,U,bool,C>(std::not_equal_to<V>{}, i, j);
 	}
@@ -165,7 +210,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto less(I i, J j)
+	constexpr auto less(I i, J j)
 	{
 		return iter::make_binop<std::less<V>,I,J,T,U,bool,C>(std::less<V>{}, i, j);
 	}
@@ -178,7 +223,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto less_equal(I i, J j)
+	constexpr auto less_equal(I i, J j)
 	{
 		return iter::make_binop<std::less_equal<V>,I,J,T,U,bool,C>(std::less_equal<V>{}, i, j);
 	}
@@ -191,7 +236,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto greater(I i, J j)
+	constexpr auto greater(I i, J j)
 	{
 		return iter::make_binop<std::greater<V>,I,J,T,U,bool,C>(std::greater<V>{}, i, j);
 	}
@@ -204,7 +249,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto greater_equal(I i, J j)
+	constexpr auto greater_equal(I i, J j)
 	{
 		return iter::make_binop<std::greater_equal<V>,I,J,T,U,bool,C>(std::greater_equal<V>{}, i, j);
 	}
@@ -218,7 +263,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto logical_and(I i, J j)
+	constexpr auto logical_and(I i, J j)
 	{
 		return iter::make_binop<std::logical_and<V>,I,J,T,U,bool,C>(std::logical_and<V>{}, i, j);
 	}
@@ -231,7 +276,7 @@ namespace iter {
 			typename std::iterator_traits<J>::iterator_category
 		>
 	>
-	inline auto logical_or(I i, J j)
+	constexpr auto logical_or(I i, J j)
 	{
 		return iter::make_binop<std::logical_or<V>,I,J,T,U,bool,C>(std::logical_or<V>{}, i, j);
 	}
@@ -353,6 +398,15 @@ inline void test_expr()
 
 //		auto d = (e(a) == e(a));
 	}
+	{
+		int b[3];
+		auto ab = ce(a, 3)*iota(1) + c(1);
+		ensure (ab.extent() == 3);
+		ab.fill(b, 2);
+		ensure (b[0] == 1*1 + 1 && b[1] == 2*2 + 1);
+		ensure (*ab == 3*3 + 1);
+		ensure (!block::finite(e(a) + c(1)));
+	}
 
 }
 #endif // _DEBUG
@@ -11,26 +11,26 @@ namespace iter {
 	class factorial_ : public enumerator<void,N,std::input_iterator_tag> {
 		N n, n_; // n, n!
 	public:
-		factorial_()
+		constexpr factorial_()
 			: n(0), n_(1)
 		{
 		}
 
-		operator bool() const
+		constexpr operator bool() const
 		{
 			return true;
 		}
-		N operator*() const
+		constexpr N operator*() const
 		{
 			return n_;
 		}
-		factorial_& operator++()
+		constexpr factorial_& operator++()
 		{
 			n_ *= ++n;
 
 			return *this;
 		}
-		factorial_ operator++(int)
+		constexpr factorial_ operator++(int)
 		{
 			factorial_ f(*this);
 
@@ -40,7 +40,7 @@ namespace iter {
 		}
 	};
 	template<class N = unsigned long long>
-	inline auto factorial()
+	constexpr auto factorial()
 	{
 		return factorial_<N>();
 	}
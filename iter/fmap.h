@@ -1,5 +1,7 @@
 // fmap.h - enumerator of enumerators
 #pragma once
+#include "block.h"
+#include "callable.h"
 #include "enumerator.h"
 
 namespace iter {
@@ -11,10 +13,11 @@ namespace iter {
 		class C = typename std::iterator_traits<I>::iterator_category
 	>
 	class fmap_ : public enumerator<I,U,C> {
-		F f;
+		detail::callable<F> f;
 	public:
 		using enumerator<I,U,C>::i;
 		typedef typename enumerator_traits<I>::is_counted is_counted;
+		typedef block::is_fillable<I> is_fillable;
 
 		fmap_()
 		{ }
@@ -22,6 +25,23 @@ namespace iter {
 			: enumerator<I,U,C>(i), f(f)
 		{ }
 
+		size_t extent() const
+		{
+			return block::extent(i);
+		}
+		template<class V>
+		void fill(V* b, size_t n)
+		{
+			T t[block::size];
+
+			for (size_t k = 0; k < n; k += block::size) {
+				size_t m = std::min(n - k, block::size);
+				auto t_ = block::view(i, t, m);
+				for (size_t j = 0; j < m; ++j)
+					b[k + j] = f(t_[j]);
+			}
+		}
+
 		operator bool() const
 		{
 			return i;
@@ -119,6 +139,71 @@ namespace iter {
 	{
 		return flatten_<I,typename T::value_type>(i);
 	}
+
+	// flatten(fmap(f, i)) with the inner enumerator held in place
+	// f(i[0])[0], f(i[0])[1], ..., f(i[1])[0], ...
+	template<class F, class I, 
+		class T = typename std::iterator_traits<I>::value_type,
+		class J = typename std::result_of_t<F(T)>,
+		class U = typename std::iterator_traits<J>::value_type
+	>
+	class flat_map_ : public enumerator<I,U,std::input_iterator_tag> {
+		detail::callable<F> f;
+		J j;
+		// next nonempty f(i[k])
+		void seek()
+		{
+			while (i && !(j = f(*i)))
+				++i;
+		}
+	public:
+		using enumerator<I,U,std::input_iterator_tag>::i;
+		typedef std::false_type is_counted;
+
+		flat_map_()
+		{ }
+		flat_map_(F f, I i)
+			: enumerator<I,U,std::input_iterator_tag>(i), f(f)
+		{
+			seek();
+		}
+
+		operator bool() const
+		{
+			return i;
+		}
+		U operator*() const
+		{
+			return *j;
+		}
+		flat_map_& operator++()
+		{
+			if (!++j) {
+				++i;
+				seek();
+			}
+
+			return *this;
+		}
+		flat_map_ operator++(int)
+		{
+			flat_map_ f_(*this);
+
+			operator++();
+
+			return f_;
+		}
+	};
+	template<class F, class I, 
+		class T = typename std::iterator_traits<I>::value_type,
+		class J = typename std::result_of_t<F(T)>,
+		class U = typename std::iterator_traits<J>::value_type
+	>
+	inline auto flat_map(F f, I i)
+	{
+		return flat_map_<F,I,T,J,U>(f, i);
+	}
+
 	// bind
 	// return
 
@@ -127,6 +212,9 @@ namespace iter {
 #ifdef _DEBUG
 #include "include/ensure.h"
 #include "constant.h"
+#include "iota.h"
+#include "level.h"
+#include "enumerator/counted.h"
 
 inline void test_fmap()
 {
@@ -181,6 +269,27 @@ inline void test_fmap()
 		++_a;
 		ensure (*_a == 3);
 	}
+	{
+		int a[] = {1,0,2,0,0,3};
+		auto _a = flat_map([](int i) { return ce(c(i),i); }, ce(a));
+		int b[] = {1,2,2,3,3,3};
+		for (int k = 0; k < 6; ++k, ++_a)
+			ensure (_a && *_a == b[k]);
+		ensure (!_a);
+
+		auto _b = flat_map([](int i) { return ce(c(i),i); }, ce(a + 3, 2));
+		ensure (!_b);
+
+		// pairs with sum 2, 3, ...
+		auto l = flat_map([](int n) { return level(n); }, iota(2));
+		ensure (*l == std::make_pair(0,2));
+		for (int k = 0; k < 3; ++k)
+			++l;
+		ensure (*l == std::make_pair(0,3));
+		auto l2(l);
+		l = l2;
+		ensure (*++l == std::make_pair(1,2));
+	}
 }
 
 #endif // _DEBUG
\ No newline at end of file
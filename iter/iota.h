@@ -1,5 +1,8 @@
 // iota.h - input iterator 0, 1, 2, ...
 #pragma once
+#include <cmath>
+#include <limits>
+#include "block.h"
 #include "enumerator.h"
 
 namespace iter {
@@ -8,26 +11,64 @@ namespace iter {
 	template<class T>
 	class iota_ : public enumerator<void, T, std::input_iterator_tag> {
 		T t;
+
+		bool exact(size_t, std::true_type) const
+		{
+			return true;
+		}
+		bool exact(size_t n, std::false_type) const
+		{
+			const T m = T(1) / std::numeric_limits<T>::epsilon();
+
+			return t == std::floor(t) && std::fabs(t) + T(n) < m;
+		}
+		// false unless T is arithmetic, e.g., simd
+		bool exact(size_t n) const
+		{
+			return std::is_arithmetic<T>::value
+				&& exact(n, std::integral_constant<bool, !std::is_floating_point<T>::value>{});
+		}
 	public:
-		iota_(T t = 0)
+		typedef std::true_type is_fillable;
+
+		constexpr iota_(T t = 0)
 			: t(t)
 		{ }
 
-		operator bool() const
+		size_t extent() const
+		{
+			return block::infinite;
+		}
+		// t + k is exactly t incremented k times for integral values
+		template<class U>
+		void fill(U* b, size_t n)
+		{
+			if (n <= block::size && exact(n)) {
+				for (size_t k = 0; k < n; ++k)
+					b[k] = t + T(static_cast<int>(k)); // int converts in SIMD registers
+				t += T(n);
+			}
+			else {
+				for (size_t k = 0; k < n; ++k, ++t)
+					b[k] = t;
+			}
+		}
+
+		constexpr operator bool() const
 		{
 			return true;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return t;
 		}
-		iota_& operator++()
+		constexpr iota_& operator++()
 		{
 			++t;
 
 			return *this;
 		}
-		iota_ operator++(int)
+		constexpr iota_ operator++(int)
 		{
 			iota_ i_(*this);
 
@@ -37,7 +78,7 @@ namespace iter {
 		}
 	};
 	template<class T>
-	inline auto iota(T t = T(0))
+	constexpr auto iota(T t = T(0))
 	{
 		return iota_<T>(t);
 	}
@@ -62,6 +103,22 @@ inline void test_iota()
 	ensure (*i++ == 2);
 	ensure (*i == 3);
 	ensure (*++i == 4);
+
+	int b[3];
+	i.fill(b, 3);
+	ensure (b[0] == 4 && b[1] == 5 && b[2] == 6);
+	ensure (*i == 7);
+
+	double d[3];
+	auto x = iota(0.5);
+	x.fill(d, 3);
+	ensure (d[0] == 0.5 && d[1] == 1.5 && d[2] == 2.5);
+	ensure (*x == 3.5);
+	x = iota(0.1);
+	auto y(x);
+	x.fill(d, 3);
+	ensure (d[0] == *y++ && d[1] == *y++ && d[2] == *y++);
+	ensure (*x == *y);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -102,24 +102,35 @@ int main()
 		test_accumulate();
 		test_adjacent();
 		test_apply();
+		test_block();
+		test_callable();
 		test_choose();
 		test_concatenate();
+		test_converge();
 		test_constant();
 		test_enumerator();
 		test_enumerator_counted();
 		test_enumerator_end();
 		test_enumerator_null();
 		test_enumerator_reverse();
+		test_eval();
 		test_expr();
 		test_factorial();
 		test_fmap();
 		test_iota();
+		test_kernel();
 		test_last();
 		test_level();
+		test_memo();
 		test_pick();
 		test_pair();
+		test_par();
 		test_pow();
+		test_probe();
+		test_simd();
 		test_skip();
+		test_summation();
+		test_table();
 		test_take();
 		test_where();
 		test_util();
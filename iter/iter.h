@@ -8,24 +8,35 @@
 #include "accumulate.h"
 #include "adjacent.h"
 #include "apply.h"
+#include "block.h"
+#include "callable.h"
 #include "concatenate.h"
 #include "constant.h"
+#include "converge.h"
 #include "choose.h"
 #include "enumerator.h"
 #include "enumerator/counted.h"
 #include "enumerator/end.h"
 #include "enumerator/null.h"
 #include "enumerator/reverse.h"
+#include "eval.h"
 #include "expr.h"
 #include "factorial.h"
 #include "fmap.h"
 #include "iota.h"
+#include "kernel.h"
 #include "last.h"
 #include "level.h"
+#include "memo.h"
 #include "pick.h"
 #include "pair.h"
+#include "par.h"
 #include "pow.h"
+#include "probe.h"
+#include "simd.h"
 #include "skip.h"
+#include "summation.h"
+#include "table.h"
 #include "take.h"
 #include "util.h"
 #include "where.h"
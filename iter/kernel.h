@@ -0,0 +1,542 @@
+// kernel.h - reductions over contiguous memory
+// Used by sum0, prod1, all, and any when the enumerator is a counted pointer.
+#pragma once
+#include <cstddef>
+
+#if defined(__AVX512F__)
+#define ITER_AVX512
+#endif
+#if defined(__AVX2__)
+#define ITER_AVX2
+#endif
+#if defined(__AVX__)
+#define ITER_AVX
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ITER_SSE2
+#endif
+// fused multiply add instructions, /arch:AVX2 implies them
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ITER_FMA
+#endif
+#if defined(ITER_AVX) || defined(ITER_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace iter {
+
+	namespace kernel {
+
+		// s + p[0] + ... + p[n-1] using independent accumulators
+		template<class T>
+		inline T sum(const T* p, size_t n, T s)
+		{
+			T s0(0), s1(0), s2(0), s3(0);
+			size_t k = 0;
+
+			for (; k + 4 <= n; k += 4) {
+				s0 += p[k];
+				s1 += p[k + 1];
+				s2 += p[k + 2];
+				s3 += p[k + 3];
+			}
+			for (; k < n; ++k)
+				s0 += p[k];
+
+			return s + ((s0 + s1) + (s2 + s3));
+		}
+
+		// s * p[0] * ... * p[n-1] using independent accumulators
+		template<class T>
+		inline T prod(const T* p, size_t n, T s)
+		{
+			T s0(1), s1(1), s2(1), s3(1);
+			size_t k = 0;
+
+			for (; k + 4 <= n; k += 4) {
+				s0 *= p[k];
+				s1 *= p[k + 1];
+				s2 *= p[k + 2];
+				s3 *= p[k + 3];
+			}
+			for (; k < n; ++k)
+				s0 *= p[k];
+
+			return s * ((s0 * s1) * (s2 * s3));
+		}
+
+		// test a block at a time so the compiler can vectorize the comparisons
+		template<class T>
+		inline bool all(const T* p, size_t n)
+		{
+			const size_t b = 16;
+			size_t k = 0;
+
+			for (; k + b <= n; k += b) {
+				bool z = false;
+				for (size_t j = 0; j < b; ++j)
+					z |= (0 == p[k + j]);
+				if (z)
+					return false;
+			}
+			for (; k < n; ++k)
+				if (0 == p[k])
+					return false;
+
+			return true;
+		}
+
+		template<class T>
+		inline bool any(const T* p, size_t n)
+		{
+			const size_t b = 16;
+			size_t k = 0;
+
+			for (; k + b <= n; k += b) {
+				bool z = false;
+				for (size_t j = 0; j < b; ++j)
+					z |= (0 != p[k + j]);
+				if (z)
+					return true;
+			}
+			for (; k < n; ++k)
+				if (0 != p[k])
+					return true;
+
+			return false;
+		}
+
+		// number of bits set in the low byte
+		inline unsigned popcount8(unsigned b)
+		{
+			static const unsigned char c[16] = {0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
+
+			return c[b & 15] + c[(b >> 4) & 15];
+		}
+
+		// copy p[k] with m[k] nonzero to q and return the number copied
+		// q must have room for n values
+		template<class T>
+		inline size_t compress(const T* p, const unsigned char* m, size_t n, T* q)
+		{
+			size_t j = 0;
+
+			for (size_t k = 0; k < n; ++k) {
+				q[j] = p[k];
+				j += (m[k] != 0);
+			}
+
+			return j;
+		}
+
+#if defined(ITER_AVX512)
+
+		inline size_t compress(const double* p, const unsigned char* m, size_t n, double* q)
+		{
+			const __m512i z = _mm512_setzero_si512();
+			size_t j = 0, k = 0;
+
+			for (; k + 8 <= n; k += 8) {
+				__m512i mk = _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i*)(m + k)));
+				__mmask8 b = _mm512_cmpneq_epi64_mask(mk, z);
+				_mm512_mask_compressstoreu_pd(q + j, b, _mm512_loadu_pd(p + k));
+				j += popcount8(b);
+			}
+			for (; k < n; ++k) {
+				q[j] = p[k];
+				j += (m[k] != 0);
+			}
+
+			return j;
+		}
+
+#elif defined(ITER_AVX2)
+
+		// 32 bit lanes that move kept doubles to the front for each 4 bit mask
+		inline const int* compress_index(int b)
+		{
+			alignas(32) static const int i[16][8] = {
+				{0,1,2,3,4,5,6,7}, {0,1,2,3,4,5,6,7}, {2,3,0,1,4,5,6,7}, {0,1,2,3,4,5,6,7},
+				{4,5,0,1,2,3,6,7}, {0,1,4,5,2,3,6,7}, {2,3,4,5,0,1,6,7}, {0,1,2,3,4,5,6,7},
+				{6,7,0,1,2,3,4,5}, {0,1,6,7,2,3,4,5}, {2,3,6,7,0,1,4,5}, {0,1,2,3,6,7,4,5},
+				{4,5,6,7,0,1,2,3}, {0,1,4,5,6,7,2,3}, {2,3,4,5,6,7,0,1}, {0,1,2,3,4,5,6,7},
+			};
+
+			return i[b];
+		}
+		inline size_t compress(const double* p, const unsigned char* m, size_t n, double* q)
+		{
+			size_t j = 0, k = 0;
+
+			for (; k + 4 <= n; k += 4) {
+				int b = (m[k] != 0) | (m[k + 1] != 0) << 1 | (m[k + 2] != 0) << 2 | (m[k + 3] != 0) << 3;
+				__m256i i = _mm256_load_si256((const __m256i*)compress_index(b));
+				__m256 v = _mm256_permutevar8x32_ps(_mm256_castpd_ps(_mm256_loadu_pd(p + k)), i);
+				_mm256_storeu_pd(q + j, _mm256_castps_pd(v));
+				j += popcount8(b);
+			}
+			for (; k < n; ++k) {
+				q[j] = p[k];
+				j += (m[k] != 0);
+			}
+
+			return j;
+		}
+
+#endif // ITER_AVX512 || ITER_AVX2
+
+#if defined(ITER_AVX)
+
+		inline double hadd(__m256d x)
+		{
+			__m128d s = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+
+			return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+		}
+		inline double hmul(__m256d x)
+		{
+			__m128d s = _mm_mul_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+
+			return _mm_cvtsd_f64(_mm_mul_sd(s, _mm_unpackhi_pd(s, s)));
+		}
+		inline float hadd(__m256 x)
+		{
+			__m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+			s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+
+			return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+		}
+		inline float hmul(__m256 x)
+		{
+			__m128 s = _mm_mul_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+			s = _mm_mul_ps(s, _mm_movehl_ps(s, s));
+
+			return _mm_cvtss_f32(_mm_mul_ss(s, _mm_shuffle_ps(s, s, 1)));
+		}
+
+		inline double sum(const double* p, size_t n, double s)
+		{
+			__m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				s0 = _mm256_add_pd(s0, _mm256_loadu_pd(p + k));
+				s1 = _mm256_add_pd(s1, _mm256_loadu_pd(p + k + 4));
+				s2 = _mm256_add_pd(s2, _mm256_loadu_pd(p + k + 8));
+				s3 = _mm256_add_pd(s3, _mm256_loadu_pd(p + k + 12));
+			}
+			for (; k + 4 <= n; k += 4)
+				s0 = _mm256_add_pd(s0, _mm256_loadu_pd(p + k));
+			double t = hadd(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+			for (; k < n; ++k)
+				t += p[k];
+
+			return s + t;
+		}
+		inline double prod(const double* p, size_t n, double s)
+		{
+			__m256d s0 = _mm256_set1_pd(1), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				s0 = _mm256_mul_pd(s0, _mm256_loadu_pd(p + k));
+				s1 = _mm256_mul_pd(s1, _mm256_loadu_pd(p + k + 4));
+				s2 = _mm256_mul_pd(s2, _mm256_loadu_pd(p + k + 8));
+				s3 = _mm256_mul_pd(s3, _mm256_loadu_pd(p + k + 12));
+			}
+			for (; k + 4 <= n; k += 4)
+				s0 = _mm256_mul_pd(s0, _mm256_loadu_pd(p + k));
+			double t = hmul(_mm256_mul_pd(_mm256_mul_pd(s0, s1), _mm256_mul_pd(s2, s3)));
+			for (; k < n; ++k)
+				t *= p[k];
+
+			return s * t;
+		}
+		inline bool all(const double* p, size_t n)
+		{
+			const __m256d z = _mm256_setzero_pd();
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				__m256d m = _mm256_or_pd(
+					_mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + k), z, _CMP_EQ_OQ),
+					             _mm256_cmp_pd(_mm256_loadu_pd(p + k + 4), z, _CMP_EQ_OQ)),
+					_mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + k + 8), z, _CMP_EQ_OQ),
+					             _mm256_cmp_pd(_mm256_loadu_pd(p + k + 12), z, _CMP_EQ_OQ)));
+				if (_mm256_movemask_pd(m))
+					return false;
+			}
+			for (; k < n; ++k)
+				if (0 == p[k])
+					return false;
+
+			return true;
+		}
+		inline bool any(const double* p, size_t n)
+		{
+			const __m256d z = _mm256_setzero_pd();
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				__m256d m = _mm256_or_pd(
+					_mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + k), z, _CMP_NEQ_UQ),
+					             _mm256_cmp_pd(_mm256_loadu_pd(p + k + 4), z, _CMP_NEQ_UQ)),
+					_mm256_or_pd(_mm256_cmp_pd(_mm256_loadu_pd(p + k + 8), z, _CMP_NEQ_UQ),
+					             _mm256_cmp_pd(_mm256_loadu_pd(p + k + 12), z, _CMP_NEQ_UQ)));
+				if (_mm256_movemask_pd(m))
+					return true;
+			}
+			for (; k < n; ++k)
+				if (0 != p[k])
+					return true;
+
+			return false;
+		}
+
+		inline float sum(const float* p, size_t n, float s)
+		{
+			__m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 32 <= n; k += 32) {
+				s0 = _mm256_add_ps(s0, _mm256_loadu_ps(p + k));
+				s1 = _mm256_add_ps(s1, _mm256_loadu_ps(p + k + 8));
+				s2 = _mm256_add_ps(s2, _mm256_loadu_ps(p + k + 16));
+				s3 = _mm256_add_ps(s3, _mm256_loadu_ps(p + k + 24));
+			}
+			for (; k + 8 <= n; k += 8)
+				s0 = _mm256_add_ps(s0, _mm256_loadu_ps(p + k));
+			float t = hadd(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+			for (; k < n; ++k)
+				t += p[k];
+
+			return s + t;
+		}
+		inline float prod(const float* p, size_t n, float s)
+		{
+			__m256 s0 = _mm256_set1_ps(1), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 32 <= n; k += 32) {
+				s0 = _mm256_mul_ps(s0, _mm256_loadu_ps(p + k));
+				s1 = _mm256_mul_ps(s1, _mm256_loadu_ps(p + k + 8));
+				s2 = _mm256_mul_ps(s2, _mm256_loadu_ps(p + k + 16));
+				s3 = _mm256_mul_ps(s3, _mm256_loadu_ps(p + k + 24));
+			}
+			for (; k + 8 <= n; k += 8)
+				s0 = _mm256_mul_ps(s0, _mm256_loadu_ps(p + k));
+			float t = hmul(_mm256_mul_ps(_mm256_mul_ps(s0, s1), _mm256_mul_ps(s2, s3)));
+			for (; k < n; ++k)
+				t *= p[k];
+
+			return s * t;
+		}
+
+#elif defined(ITER_SSE2)
+
+		inline double hadd(__m128d x)
+		{
+			return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+		}
+		inline double hmul(__m128d x)
+		{
+			return _mm_cvtsd_f64(_mm_mul_sd(x, _mm_unpackhi_pd(x, x)));
+		}
+		inline float hadd(__m128 x)
+		{
+			x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+
+			return _mm_cvtss_f32(_mm_add_ss(x, _mm_shuffle_ps(x, x, 1)));
+		}
+		inline float hmul(__m128 x)
+		{
+			x = _mm_mul_ps(x, _mm_movehl_ps(x, x));
+
+			return _mm_cvtss_f32(_mm_mul_ss(x, _mm_shuffle_ps(x, x, 1)));
+		}
+
+		inline double sum(const double* p, size_t n, double s)
+		{
+			__m128d s0 = _mm_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 8 <= n; k += 8) {
+				s0 = _mm_add_pd(s0, _mm_loadu_pd(p + k));
+				s1 = _mm_add_pd(s1, _mm_loadu_pd(p + k + 2));
+				s2 = _mm_add_pd(s2, _mm_loadu_pd(p + k + 4));
+				s3 = _mm_add_pd(s3, _mm_loadu_pd(p + k + 6));
+			}
+			double t = hadd(_mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+			for (; k < n; ++k)
+				t += p[k];
+
+			return s + t;
+		}
+		inline double prod(const double* p, size_t n, double s)
+		{
+			__m128d s0 = _mm_set1_pd(1), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 8 <= n; k += 8) {
+				s0 = _mm_mul_pd(s0, _mm_loadu_pd(p + k));
+				s1 = _mm_mul_pd(s1, _mm_loadu_pd(p + k + 2));
+				s2 = _mm_mul_pd(s2, _mm_loadu_pd(p + k + 4));
+				s3 = _mm_mul_pd(s3, _mm_loadu_pd(p + k + 6));
+			}
+			double t = hmul(_mm_mul_pd(_mm_mul_pd(s0, s1), _mm_mul_pd(s2, s3)));
+			for (; k < n; ++k)
+				t *= p[k];
+
+			return s * t;
+		}
+		inline bool all(const double* p, size_t n)
+		{
+			const __m128d z = _mm_setzero_pd();
+			size_t k = 0;
+
+			for (; k + 8 <= n; k += 8) {
+				__m128d m = _mm_or_pd(
+					_mm_or_pd(_mm_cmpeq_pd(_mm_loadu_pd(p + k), z), _mm_cmpeq_pd(_mm_loadu_pd(p + k + 2), z)),
+					_mm_or_pd(_mm_cmpeq_pd(_mm_loadu_pd(p + k + 4), z), _mm_cmpeq_pd(_mm_loadu_pd(p + k + 6), z)));
+				if (_mm_movemask_pd(m))
+					return false;
+			}
+			for (; k < n; ++k)
+				if (0 == p[k])
+					return false;
+
+			return true;
+		}
+		inline bool any(const double* p, size_t n)
+		{
+			const __m128d z = _mm_setzero_pd();
+			size_t k = 0;
+
+			for (; k + 8 <= n; k += 8) {
+				__m128d m = _mm_or_pd(
+					_mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(p + k), z), _mm_cmpneq_pd(_mm_loadu_pd(p + k + 2), z)),
+					_mm_or_pd(_mm_cmpneq_pd(_mm_loadu_pd(p + k + 4), z), _mm_cmpneq_pd(_mm_loadu_pd(p + k + 6), z)));
+				if (_mm_movemask_pd(m))
+					return true;
+			}
+			for (; k < n; ++k)
+				if (0 != p[k])
+					return true;
+
+			return false;
+		}
+
+		inline float sum(const float* p, size_t n, float s)
+		{
+			__m128 s0 = _mm_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				s0 = _mm_add_ps(s0, _mm_loadu_ps(p + k));
+				s1 = _mm_add_ps(s1, _mm_loadu_ps(p + k + 4));
+				s2 = _mm_add_ps(s2, _mm_loadu_ps(p + k + 8));
+				s3 = _mm_add_ps(s3, _mm_loadu_ps(p + k + 12));
+			}
+			float t = hadd(_mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+			for (; k < n; ++k)
+				t += p[k];
+
+			return s + t;
+		}
+		inline float prod(const float* p, size_t n, float s)
+		{
+			__m128 s0 = _mm_set1_ps(1), s1 = s0, s2 = s0, s3 = s0;
+			size_t k = 0;
+
+			for (; k + 16 <= n; k += 16) {
+				s0 = _mm_mul_ps(s0, _mm_loadu_ps(p + k));
+				s1 = _mm_mul_ps(s1, _mm_loadu_ps(p + k + 4));
+				s2 = _mm_mul_ps(s2, _mm_loadu_ps(p + k + 8));
+				s3 = _mm_mul_ps(s3, _mm_loadu_ps(p + k + 12));
+			}
+			float t = hmul(_mm_mul_ps(_mm_mul_ps(s0, s1), _mm_mul_ps(s2, s3)));
+			for (; k < n; ++k)
+				t *= p[k];
+
+			return s * t;
+		}
+
+#endif // ITER_AVX || ITER_SSE2
+
+	} // kernel
+
+} // iter
+
+#ifdef _DEBUG
+#include <algorithm>
+#include <vector>
+#include "include/ensure.h"
+
+template<class T>
+inline void test_kernel_type()
+{
+	using namespace iter;
+
+	for (size_t n : {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 64, 100}) {
+		std::vector<T> a(n + 1);
+		T s = 0, p = 1;
+		for (size_t k = 0; k < n; ++k) {
+			a[k] = T(1 + (k%7 == 1)); // products are exact
+			s += a[k];
+			p *= a[k];
+		}
+		ensure (kernel::sum(a.data(), n, T(1)) == T(1) + s);
+		ensure (kernel::prod(a.data(), n, T(3)) == T(3)*p);
+		ensure (kernel::all(a.data(), n));
+		ensure (kernel::any(a.data(), n) == (n != 0));
+		if (n) {
+			a[n - 1] = 0;
+			ensure (!kernel::all(a.data(), n));
+			ensure (kernel::any(a.data(), n) == (n > 1));
+		}
+		std::fill(a.begin(), a.end(), T(0));
+		ensure (!kernel::any(a.data(), n));
+		ensure (kernel::all(a.data(), n) == (n == 0));
+	}
+}
+
+template<class T>
+inline void test_kernel_compress()
+{
+	using iter::kernel::compress;
+
+	T p[37], q[37];
+	unsigned char m[37];
+	for (int k = 0; k < 37; ++k) {
+		p[k] = T(k);
+		m[k] = (k%3 == 0) || (k%7 == 2);
+	}
+	size_t n = compress(p, m, 37, q);
+	size_t j = 0;
+	for (int k = 0; k < 37; ++k)
+		if (m[k])
+			ensure (q[j++] == p[k]);
+	ensure (n == j);
+
+	for (int b = 0; b < 256; ++b) {
+		for (int k = 0; k < 8; ++k)
+			m[k] = (b >> k) & 1;
+		n = compress(p, m, 8, q);
+		ensure (n == iter::kernel::popcount8(b));
+		j = 0;
+		for (int k = 0; k < 8; ++k)
+			if (m[k])
+				ensure (q[j++] == p[k]);
+	}
+}
+
+inline void test_kernel()
+{
+	test_kernel_compress<double>();
+	test_kernel_compress<int>();
+	test_kernel_type<double>();
+	test_kernel_type<float>();
+	test_kernel_type<int>();
+}
+
+#endif // _DEBUG
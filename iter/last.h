@@ -2,13 +2,16 @@
 // last, back = *last
 #pragma once
 #include <utility>
+#include "block.h"
+#include "kernel.h"
+#include "summation.h"
 #include "enumerator/counted.h"
 #include "enumerator/reverse.h"
 
 namespace iter {
 
 	template<class E>
-	inline size_t size(E e)
+	constexpr size_t size(E e)
 	{
 		size_t n = 0;
 
@@ -27,7 +30,7 @@ namespace iter {
 
 	/// iterate to just before end
 	template<class E>
-	inline E last(E e)
+	constexpr E last(E e)
 	{
 		E l(e);
 
@@ -39,7 +42,7 @@ namespace iter {
 	}
 
 	template<class E>
-	inline E end(E e)
+	constexpr E end(E e)
 	{
 		while (++e)
 			;
@@ -57,33 +60,202 @@ namespace iter {
 	{
 		return ce(re(r.end()),r.size());
 	}
+	namespace detail {
+
+		template<class E>
+		constexpr typename std::iterator_traits<E>::value_type back(E e, std::false_type)
+		{
+			return *last(e);
+		}
+		template<class E>
+		inline typename std::iterator_traits<E>::value_type back_block(E e)
+		{
+			typename std::iterator_traits<E>::value_type v;
+			block::for_each(e, [&v](const auto* b, size_t m) { v = b[m - 1]; });
+
+			return v;
+		}
+		template<class E>
+		constexpr typename std::iterator_traits<E>::value_type back(E e, std::true_type)
+		{
+			if (!block::finite(e) || block::extent(e) == 0)
+				return back(e, std::false_type{});
+
+			return back_block(e);
+		}
+
+		// s + b[0] + ... + b[n-1]
+		template<class V, class T>
+		inline T add(const V* b, size_t n, T s)
+		{
+			for (size_t k = 0; k < n; ++k)
+				s += b[k];
+
+			return s;
+		}
+		template<class T>
+		inline T add(const T* b, size_t n, T s)
+		{
+			return kernel::sum(b, n, s);
+		}
+		// s * b[0] * ... * b[n-1]
+		template<class V, class T>
+		inline T mul(const V* b, size_t n, T s)
+		{
+			for (size_t k = 0; k < n; ++k)
+				s *= b[k];
+
+			return s;
+		}
+		template<class T>
+		inline T mul(const T* b, size_t n, T s)
+		{
+			return kernel::prod(b, n, s);
+		}
+
+		template<class E, class T>
+		constexpr T sum0(E e, T s, std::false_type)
+		{
+			while (e) {
+				s += *e;
+				++e;
+			}
+
+			return s;
+		}
+		template<class E, class T>
+		inline T sum0_block(E e, T s)
+		{
+			block::for_each(e, [&s](const auto* b, size_t m) { s = add(b, m, s); });
+
+			return s;
+		}
+		template<class E, class T>
+		constexpr T sum0(E e, T s, std::true_type)
+		{
+			if (!block::finite(e))
+				return sum0(e, s, std::false_type{});
+
+			return sum0_block(e, s);
+		}
+
+		template<class E, class T>
+		constexpr T prod1(E e, T s, std::false_type)
+		{
+			while (e) {
+				s *= *e;
+				++e;
+			}
+
+			return s;
+		}
+		template<class E, class T>
+		inline T prod1_block(E e, T s)
+		{
+			block::for_each(e, [&s](const auto* b, size_t m) { s = mul(b, m, s); });
+
+			return s;
+		}
+		template<class E, class T>
+		constexpr T prod1(E e, T s, std::true_type)
+		{
+			if (!block::finite(e))
+				return prod1(e, s, std::false_type{});
+
+			return prod1_block(e, s);
+		}
+
+	} // detail
+
+	// a block at a time if e is fillable and ITER_BLOCK
+	// one at a time during constant evaluation, see step:: for old compilers
 	template<class E>
-	inline typename std::iterator_traits<E>::value_type back(E e)
+	ITER_CONSTEXPR_KERNEL typename std::iterator_traits<E>::value_type back(E e)
 	{
-		return *last(e);
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::back(e, std::false_type{});
+
+		return detail::back(e, block::use<E>{});
 	}
 	// sum enumerators
 	template<class E, class T = typename std::iterator_traits<E>::value_type>
+	ITER_CONSTEXPR_KERNEL T sum0(E e, T s = T(0))
+	{
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::sum0(e, s, std::false_type{});
+
+		return detail::sum0(e, s, block::use<E>{});
+	}
+	// sum using summation policy S, e.g., sum0<summation::neumaier>(e)
+	template<template<class> class S, class E, class T = typename std::iterator_traits<E>::value_type>
 	inline T sum0(E e, T s = T(0))
 	{
-		while (e) {
-			s += *e;
-			++e;
-		}
+		return detail::sum0(e, S<T>(s), block::use<E>{});
+	}
+	// contiguous memory
+	template<class T>
+	ITER_CONSTEXPR_KERNEL T sum0(counted_enumerator<T*,T> e, T s = T(0))
+	{
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::sum0(e, s, std::false_type{});
+
+		return kernel::sum(e.begin(), e.size(), s);
+	}
+	template<class T>
+	ITER_CONSTEXPR_KERNEL T sum0(counted_enumerator<const T*,T> e, T s = T(0))
+	{
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::sum0(e, s, std::false_type{});
 
-		return s;
+		return kernel::sum(e.begin(), e.size(), s);
 	}
 	// multiply null enumerators
 	template<class E, class T = typename std::iterator_traits<E>::value_type>
-	inline T prod1(E e, T s = T(1))
+	ITER_CONSTEXPR_KERNEL T prod1(E e, T s = T(1))
 	{
-		while (e) {
-			s *= *e;
-			++e;
-		}
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::prod1(e, s, std::false_type{});
+
+		return detail::prod1(e, s, block::use<E>{});
+	}
+	// contiguous memory
+	template<class T>
+	ITER_CONSTEXPR_KERNEL T prod1(counted_enumerator<T*,T> e, T s = T(1))
+	{
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::prod1(e, s, std::false_type{});
 
-		return s;
+		return kernel::prod(e.begin(), e.size(), s);
 	}
+	template<class T>
+	ITER_CONSTEXPR_KERNEL T prod1(counted_enumerator<const T*,T> e, T s = T(1))
+	{
+		if (ITER_CONSTANT_EVALUATED())
+			return detail::prod1(e, s, std::false_type{});
+
+		return kernel::prod(e.begin(), e.size(), s);
+	}
+
+	// one value at a time, constant expressions on any compiler
+	namespace step {
+
+		template<class E>
+		constexpr typename std::iterator_traits<E>::value_type back(E e)
+		{
+			return detail::back(e, std::false_type{});
+		}
+		template<class E, class T = typename std::iterator_traits<E>::value_type>
+		constexpr T sum0(E e, T s = T(0))
+		{
+			return detail::sum0(e, s, std::false_type{});
+		}
+		template<class E, class T = typename std::iterator_traits<E>::value_type>
+		constexpr T prod1(E e, T s = T(1))
+		{
+			return detail::prod1(e, s, std::false_type{});
+		}
+
+	} // step
 
 } // iter
 
@@ -110,6 +282,38 @@ inline void test_last() {
 	ra++;
 	ensure (!ra);
 
+	double x[] = {1,2,3,4,5};
+	ensure (sum0(ce(x)) == 15);
+	ensure (sum0(ce(x), 1.) == 16);
+	ensure (prod1(ce(x)) == 120);
+	ensure (prod1(ce(x, 0)) == 1);
+	ensure (sum0(ce(x)) == sum0(rend(ce(x))));
+	ensure (prod1(ce(x)) == prod1(rend(ce(x))));
+
+	double z0[] = {1, 1e100, 1, -1e100};
+	ensure (sum0<summation::plain>(ce(z0)) == 0); // in order, unlike sum0(ce(z0))
+	ensure (sum0<summation::neumaier>(ce(z0)) == 2);
+	ensure (sum0<summation::neumaier>(ce(z0), 1.) == 3);
+	ensure (iter::detail::sum0(ce(z0), summation::neumaier<double>(), std::true_type{}) == 2);
+
+	// block at a time versus one at a time
+	int y[200];
+	for (int k = 0; k < 200; ++k)
+		y[k] = k%5 - 2;
+	auto z = ce(y, 200)*c(2) + ce(y, 150)*iota(0);
+	int s = 0, p = 1, l = 0;
+	for (auto w = z; w; ++w) {
+		s += *w;
+		p *= 1 + (*w > 250);
+		l = *w;
+	}
+	ensure (sum0(z) == s);
+	ensure (iter::detail::sum0(z, 0, std::true_type{}) == s);
+	ensure (back(z) == l);
+	ensure (iter::detail::back(z, std::true_type{}) == l);
+	auto u = apply([](int i) { return 1 + (i > 250); }, z);
+	ensure (prod1(u) == p);
+	ensure (iter::detail::prod1(u, 1, std::true_type{}) == p);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -0,0 +1,186 @@
+// memo.h - memoize the values of an enumerator
+// Copies of memo(e) share a buffer of the values computed so far,
+// so e is evaluated at most once per position.
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "enumerator.h"
+
+namespace iter {
+
+	namespace detail {
+
+		// values of e in chunks of size b, 2b, 4b, ... that never move
+		template<class E, class T>
+		class memo_buffer {
+			static const size_t b = 64;
+			E e;
+			std::unique_ptr<T[]> chunk[64];
+			std::atomic<size_t> n; // number of values available
+			bool done;
+			std::mutex m;
+
+			// chunk j holds values b(2^j - 1) to b(2^(j+1) - 1)
+			static size_t index(size_t k, size_t& j)
+			{
+				size_t q = k/b + 1;
+
+				for (j = 0; q >>= 1; ++j)
+					;
+
+				return k - b*((size_t(1) << j) - 1);
+			}
+		public:
+			memo_buffer(const E& e)
+				: e(e), n(0), done(false)
+			{ }
+			memo_buffer(const memo_buffer&) = delete;
+			memo_buffer& operator=(const memo_buffer&) = delete;
+
+			// true if value k exists, computing values up to k if needed
+			bool has(size_t k)
+			{
+				if (k < n.load(std::memory_order_acquire))
+					return true;
+
+				std::lock_guard<std::mutex> l(m);
+				size_t nk = n.load(std::memory_order_relaxed);
+				for (; nk <= k && !done; ++nk) {
+					if (!e) {
+						done = true;
+						break;
+					}
+					size_t j, i = index(nk, j);
+					if (i == 0)
+						chunk[j].reset(new T[b << j]);
+					chunk[j][i] = *e;
+					++e;
+					n.store(nk + 1, std::memory_order_release);
+				}
+
+				return k < nk;
+			}
+			// k < number of values available
+			const T& operator[](size_t k) const
+			{
+				size_t j, i = index(k, j);
+
+				return chunk[j][i];
+			}
+		};
+
+	} // detail
+
+	template<class E, class T = typename std::iterator_traits<E>::value_type>
+	class memo_ : public enumerator<void,T,std::input_iterator_tag> {
+		std::shared_ptr<detail::memo_buffer<E,T>> p;
+		size_t k;
+	public:
+		memo_()
+			: k(0)
+		{ }
+		memo_(const E& e)
+			: p(std::make_shared<detail::memo_buffer<E,T>>(e)), k(0)
+		{ }
+
+		// number of values stepped over
+		size_t position() const
+		{
+			return k;
+		}
+
+		operator bool() const
+		{
+			return p && p->has(k);
+		}
+		T operator*() const
+		{
+			p->has(k);
+
+			return (*p)[k];
+		}
+		memo_& operator++()
+		{
+			++k;
+
+			return *this;
+		}
+		memo_ operator++(int)
+		{
+			memo_ m(*this);
+
+			operator++();
+
+			return m;
+		}
+	};
+	// share computed values of e among copies
+	template<class E, class T = typename std::iterator_traits<E>::value_type>
+	inline memo_<E,T> memo(const E& e)
+	{
+		return memo_<E,T>(e);
+	}
+
+} // iter
+
+#ifdef _DEBUG
+#include <thread>
+#include <vector>
+#include "include/ensure.h"
+#include "apply.h"
+#include "iota.h"
+#include "enumerator/counted.h"
+
+inline void test_memo()
+{
+	using namespace iter;
+
+	{
+		int calls = 0;
+		auto m = memo(apply([&calls](int i) { ++calls; return i*i; }, iota(0)));
+		auto m2(m);
+		ensure (*m == 0);
+		ensure (*++m == 1);
+		ensure (*++m == 4);
+		ensure (m.position() == 2);
+		int c3 = calls;
+		ensure (*m2 == 0 && *++m2 == 1 && *++m2 == 4);
+		ensure (calls == c3);
+		for (int k = 0; k < 1000; ++k)
+			++m;
+		ensure (*m == 1002*1002);
+		for (int k = 0; k < 1000; ++k)
+			++m2;
+		ensure (*m2 == 1002*1002);
+		ensure (calls <= 1004);
+	}
+	{
+		int a[] = {1,2,3};
+		auto m = memo(ce(a));
+		ensure (*m++ == 1);
+		ensure (*m++ == 2);
+		ensure (*m++ == 3);
+		ensure (!m);
+		auto n = memo(ce(a, 0));
+		ensure (!n);
+	}
+	{
+		auto m = memo(apply([](int i) { return 3*i + 1; }, iota(0)));
+		bool ok[4] = {false, false, false, false};
+		std::vector<std::thread> t;
+		for (int j = 0; j < 4; ++j) {
+			t.emplace_back([m,j,&ok]() mutable {
+				bool b = true;
+				for (int k = 0; k < 10000; ++k, ++m)
+					b = b && *m == 3*k + 1;
+				ok[j] = b;
+			});
+		}
+		for (auto& tj : t)
+			tj.join();
+		ensure (ok[0] && ok[1] && ok[2] && ok[3]);
+	}
+}
+
+#endif // _DEBUG
@@ -0,0 +1,331 @@
+// par.h - parallel reductions over random access enumerators
+// The range [0, extent(e)) is split into chunks of fixed size that are reduced
+// on a pool of worker threads and combined in chunk order, so the result does
+// not depend on the number of threads.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "block.h"
+#include "constant.h"
+#include "expr.h"
+#include "last.h"
+#include "take.h"
+#include "util.h"
+#include "enumerator/counted.h"
+
+namespace iter {
+
+	namespace par {
+
+		// reusable worker threads
+		class pool {
+			std::vector<std::thread> t;
+			std::mutex m, run_;
+			std::condition_variable go, done;
+			std::function<void(size_t)> f;
+			std::exception_ptr x;
+			std::atomic<uint64_t> next; // job in the high 32 bits, next chunk in the low
+			size_t n, busy;
+			uint32_t job;
+			bool stop;
+
+			// claim chunk k < n of job j, false once j is done or replaced
+			bool claim(uint32_t j, size_t n, size_t& k)
+			{
+				uint64_t v = next.load();
+
+				do {
+					k = static_cast<size_t>(v & 0xffffffff);
+					if (static_cast<uint32_t>(v >> 32) != j || k >= n)
+						return false;
+				} while (!next.compare_exchange_weak(v, v + 1));
+
+				return true;
+			}
+			// call f(k) for unclaimed k of job j
+			// a claimed k keeps run waiting, so f is still the function of job j
+			void work(uint32_t j, size_t n)
+			{
+				size_t k;
+
+				while (claim(j, n, k)) {
+					try {
+						f(k);
+					}
+					catch (...) {
+						std::lock_guard<std::mutex> l(m);
+						x = std::current_exception();
+					}
+				}
+			}
+			void loop()
+			{
+				uint32_t j = 0;
+
+				for (;;) {
+					size_t nj;
+					{
+						std::unique_lock<std::mutex> l(m);
+						go.wait(l, [this,j]() { return stop || job != j; });
+						if (stop)
+							return;
+						j = job;
+						nj = n;
+						++busy;
+					}
+					// a late wake up finds no chunks of job j left
+					work(j, nj);
+					{
+						std::lock_guard<std::mutex> l(m);
+						if (--busy == 0)
+							done.notify_one();
+					}
+				}
+			}
+		public:
+			// threads in addition to the calling thread
+			explicit pool(size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1)
+				: next(0), n(0), busy(0), job(0), stop(false)
+			{
+				for (size_t i = 0; i < threads; ++i)
+					t.emplace_back([this]() { loop(); });
+			}
+			pool(const pool&) = delete;
+			pool& operator=(const pool&) = delete;
+			~pool()
+			{
+				{
+					std::lock_guard<std::mutex> l(m);
+					stop = true;
+				}
+				go.notify_all();
+				for (auto& ti : t)
+					ti.join();
+			}
+
+			// number of threads used by run
+			size_t size() const
+			{
+				return t.size() + 1;
+			}
+
+			// f(0), ..., f(n-1) on the pool and the calling thread
+			// f must not call run on the same pool
+			template<class F>
+			void run(size_t n_, F f_)
+			{
+				std::lock_guard<std::mutex> r(run_);
+				uint32_t j;
+				{
+					std::lock_guard<std::mutex> l(m);
+					f = f_;
+					n = n_;
+					j = ++job;
+					next = uint64_t(j) << 32;
+					x = nullptr;
+				}
+				go.notify_all();
+				work(j, n_);
+				{
+					std::unique_lock<std::mutex> l(m);
+					done.wait(l, [this]() { return busy == 0; });
+					f = nullptr;
+				}
+				if (x)
+					std::rethrow_exception(x);
+			}
+		};
+
+		// shared by all reductions
+		inline pool& default_pool()
+		{
+			static pool p;
+
+			return p;
+		}
+
+		// number of values in a chunk, fewer than 2^32 chunks
+		static const size_t chunk = 1 << 16;
+
+		// e advanced by k in constant time
+		template<class E>
+		inline E offset(E e, size_t k)
+		{
+			static_assert(is_random_access<E>::value, "iter::par: enumerator must be random access");
+			e += k;
+
+			return e;
+		}
+
+		// values k to k + chunk of e
+		template<class E>
+		inline auto slice(const E& e, size_t n, size_t k)
+		{
+			return take(std::min(chunk, n - k), offset(e, k));
+		}
+		inline size_t chunks(size_t n)
+		{
+			return (n + chunk - 1)/chunk;
+		}
+		// number of values in e
+		template<class E>
+		inline size_t length(const E& e)
+		{
+			size_t n = block::extent(e);
+			if (n == block::infinite)
+				throw std::invalid_argument("iter::par: enumerator must be finite");
+
+			return n;
+		}
+
+		// combine chunk reductions r(slice) in order using o
+		// a single chunk is reduced on the calling thread
+		template<class E, class T, class R, class O>
+		inline T reduce(E e, T s, R r, O o, pool& p)
+		{
+			size_t n = length(e);
+			size_t nc = chunks(n);
+			if (nc <= 1)
+				return nc ? o(s, r(slice(e, n, 0))) : s;
+
+			std::vector<T> t(nc);
+
+			p.run(nc, [&](size_t c) { t[c] = r(slice(e, n, c*chunk)); });
+			for (const auto& tc : t)
+				s = o(s, tc);
+
+			return s;
+		}
+
+		// e must be random access with finite extent
+		template<class E, class T = typename std::iterator_traits<E>::value_type>
+		inline T sum0(E e, T s = T(0), pool& p = default_pool())
+		{
+			return reduce(e, s, [](auto c) { return iter::sum0(c, T(0)); }, std::plus<T>{}, p);
+		}
+		template<class E, class T = typename std::iterator_traits<E>::value_type>
+		inline T prod1(E e, T s = T(1), pool& p = default_pool())
+		{
+			return reduce(e, s, [](auto c) { return iter::prod1(c, T(1)); }, std::multiplies<T>{}, p);
+		}
+		// chunks after a decision are skipped
+		template<class E>
+		inline bool all(E e, pool& p = default_pool())
+		{
+			size_t n = length(e);
+			if (chunks(n) <= 1)
+				return iter::all(slice(e, n, 0));
+
+			std::atomic<bool> b(true);
+			p.run(chunks(n), [&](size_t c) {
+				if (b && !iter::all(slice(e, n, c*chunk)))
+					b = false;
+			});
+
+			return b;
+		}
+		template<class E>
+		inline bool any(E e, pool& p = default_pool())
+		{
+			size_t n = length(e);
+			if (chunks(n) <= 1)
+				return iter::any(slice(e, n, 0));
+
+			std::atomic<bool> b(false);
+			p.run(chunks(n), [&](size_t c) {
+				if (!b && iter::any(slice(e, n, c*chunk)))
+					b = true;
+			});
+
+			return b;
+		}
+		// t + sum i[k] j[k]
+		template<class I, class J, class T>
+		inline T inner_product(I i, J j, T t, pool& p = default_pool())
+		{
+			return sum0(make_binop(std::multiplies<T>{}, i, j), t, p);
+		}
+
+	} // par
+
+} // iter
+
+#ifdef _DEBUG
+#include <numeric>
+#include "include/ensure.h"
+
+inline void test_par()
+{
+	using namespace iter;
+
+	{
+		std::vector<double> a(3*par::chunk + 17);
+		for (size_t k = 0; k < a.size(); ++k)
+			a[k] = double(k%10);
+
+		par::pool p(3);
+		ensure (p.size() == 4);
+
+		double s = std::accumulate(a.begin(), a.end(), 0.);
+		ensure (par::sum0(ce(a.data(), a.size()), 0., p) == s);
+		ensure (par::sum0(ce(a.data(), a.size()), 1.) == s + 1);
+
+		auto ac = ce(a.data(), a.size());
+		ensure (!par::all(ac, p));
+		ensure (par::all(ac + c(1.), p));
+		ensure (par::any(ac, p));
+		ensure (!par::any(ac*c(0.), p));
+
+		double ip = std::inner_product(a.begin(), a.end(), a.begin(), 0.);
+		ensure (par::inner_product(ac, a.data(), 0., p) == ip);
+		ensure (par::sum0(ac*a.data() + c(0.), 0., p) == ip);
+
+		std::vector<double> b(a.size(), 1.);
+		b[a.size() - 1] = 2;
+		ensure (par::prod1(ce(b.data(), b.size()), 3., p) == 6);
+
+		// one chunk or none on the calling thread
+		double d[] = {1, 2, 3};
+		ensure (par::sum0(ce(d), 1., p) == 7);
+		ensure (par::sum0(ce(d, 0), 1., p) == 1);
+		ensure (par::all(ce(d), p) && !par::all(ce(d)*c(0.), p));
+		ensure (par::any(ce(d), p) && !par::any(ce(d, 0), p));
+
+		// same chunks regardless of number of threads
+		par::pool q(0);
+		ensure (par::sum0(ac*c(0.1), 0., p) == par::sum0(ac*c(0.1), 0., q));
+	}
+	{
+		par::pool p(2);
+		std::atomic<size_t> n(0);
+		p.run(100, [&n](size_t) { ++n; });
+		ensure (n == 100);
+		p.run(0, [&n](size_t) { ++n; });
+		ensure (n == 100);
+		// chunks of back to back runs are called once each
+		for (size_t r = 0; r < 1000; ++r) {
+			std::atomic<size_t> m[3] = {{0}, {0}, {0}};
+			p.run(3, [&m](size_t k) { ++m[k]; });
+			ensure (m[0] == 1 && m[1] == 1 && m[2] == 1);
+		}
+		bool thrown = false;
+		try {
+			p.run(10, [](size_t k) { if (k == 5) throw std::runtime_error("par"); });
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		ensure (thrown);
+	}
+}
+
+#endif // _DEBUG
@@ -26,6 +26,14 @@ inline void test_pick()
 	ensure (*b++ == 2);
 	ensure (*b == 3);
 	ensure (*++b == 5);
+
+	// constant time jumps
+	auto c = pick(ce(i), ce(a)*ce(a));
+	ensure (*c == 4);
+	ensure (*++c == 9);
+	ensure (*++c == 25);
+	ensure (!++c);
+	ensure (sum0(pick(ce(i), ce(a))) == 2 + 3 + 5);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -1,5 +1,6 @@
 // pow.h - powers of a number
 #pragma once
+#include "block.h"
 #include "enumerator.h"
 
 namespace iter {
@@ -9,25 +10,40 @@ namespace iter {
 	class pow_ : public enumerator<void, T, std::input_iterator_tag> {
 		T t, t_; // t, t^n
 	public:
-		pow_(T t = T(0))
+		typedef std::true_type is_fillable;
+
+		constexpr pow_(T t = T(0))
 			: t(t), t_(1)
 		{ }
 
-		operator bool() const
+		size_t extent() const
+		{
+			return block::infinite;
+		}
+		template<class U>
+		void fill(U* b, size_t n)
+		{
+			for (size_t k = 0; k < n; ++k) {
+				b[k] = t_;
+				t_ *= t;
+			}
+		}
+
+		constexpr operator bool() const
 		{
 			return true;
 		}
-		T operator*() const
+		constexpr T operator*() const
 		{
 			return t_;
 		}
-		pow_& operator++()
+		constexpr pow_& operator++()
 		{
 			t_ *= t;
 
 			return *this;
 		}
-		pow_ operator++(int)
+		constexpr pow_ operator++(int)
 		{
 			pow_ p(*this);
 
@@ -37,7 +53,7 @@ namespace iter {
 		}
 	};
 	template<class T>
-	inline auto pow(const T& t)
+	constexpr auto pow(const T& t)
 	{
 		return pow_<T>(t);
 	}
@@ -56,6 +72,11 @@ inline void test_pow()
 	p++;
 	ensure (*p == 4);
 	ensure (*++p == 8);
+
+	int b[3];
+	p.fill(b, 3);
+	ensure (b[0] == 8 && b[1] == 16 && b[2] == 32);
+	ensure (*p == 64);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -0,0 +1,304 @@
+// probe.h - count calls into a stage of a pipeline
+// probe(e, "name") enumerates the same values as e and counts calls to
+// operator bool, operator*, operator++, and values filled a block at a time.
+// probe(e, "name", n) also times every n-th call with the time stamp counter.
+// Counts go to slots owned by the calling thread, probes::report() sums them.
+// #define NREGION
+// before including to make probe(e, name) return e.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "include/region.h"
+#include "block.h"
+#include "enumerator.h"
+
+namespace iter {
+
+	namespace probes {
+
+		// written only by the owning thread
+		struct counter {
+			std::atomic<uint64_t> bools, derefs, increments, values; // calls and values filled
+			std::atomic<uint64_t> sampled, cycles; // timed calls
+			std::atomic<uint64_t> filled, fill_cycles; // timed values filled
+
+			counter()
+				: bools(0), derefs(0), increments(0), values(0), sampled(0), cycles(0), filled(0), fill_cycles(0)
+			{ }
+		};
+		typedef region::registry_<counter> registry;
+
+		inline registry& global()
+		{
+			static registry r;
+
+			return r;
+		}
+		inline size_t id(const char* name)
+		{
+			return global().id(name);
+		}
+		// slots of the calling thread
+		inline counter* local()
+		{
+			thread_local counter* c = global().add();
+
+			return c;
+		}
+
+		struct total {
+			const char* name;
+			uint64_t bools, derefs, increments, values;
+			uint64_t sampled, cycles, filled, fill_cycles;
+		};
+		// totals over all threads in order of first use
+		inline std::vector<total> totals()
+		{
+			return global().sum<total>([](total& s, const counter& c) {
+				s.bools += c.bools.load(std::memory_order_relaxed);
+				s.derefs += c.derefs.load(std::memory_order_relaxed);
+				s.increments += c.increments.load(std::memory_order_relaxed);
+				s.values += c.values.load(std::memory_order_relaxed);
+				s.sampled += c.sampled.load(std::memory_order_relaxed);
+				s.cycles += c.cycles.load(std::memory_order_relaxed);
+				s.filled += c.filled.load(std::memory_order_relaxed);
+				s.fill_cycles += c.fill_cycles.load(std::memory_order_relaxed);
+			});
+		}
+		inline void report(FILE* os = stdout)
+		{
+			fprintf(os, "%-32s %12s %12s %12s %12s %12s %12s\n", "probe", "bool", "*", "++", "filled", "cycles/call", "cycles/value");
+			for (const auto& t : totals())
+				fprintf(os, "%-32s %12llu %12llu %12llu %12llu %12.1f %12.1f\n", t.name,
+					(unsigned long long)t.bools, (unsigned long long)t.derefs, (unsigned long long)t.increments, (unsigned long long)t.values,
+					t.sampled ? double(t.cycles)/t.sampled : 0., t.filled ? double(t.fill_cycles)/t.filled : 0.);
+		}
+		inline void reset()
+		{
+			global().reset([](counter& c) {
+				for (auto a : {&c.bools, &c.derefs, &c.increments, &c.values, &c.sampled, &c.cycles, &c.filled, &c.fill_cycles})
+					a->store(0, std::memory_order_relaxed);
+			});
+		}
+
+		// smallest power of 2 not less than n
+		inline uint64_t ceil2(uint64_t n)
+		{
+			uint64_t m = 1;
+
+			while (m < n)
+				m *= 2;
+
+			return m;
+		}
+
+	} // probes
+
+	// e[0], e[1], ... counted in the slot id
+	template<class I,
+		class T = typename std::iterator_traits<I>::value_type,
+		class C = typename std::iterator_traits<I>::iterator_category
+	>
+	class probe_ : public enumerator<I,T,C> {
+		size_t id;
+		uint64_t mask; // time calls with count & mask == 0
+		bool timed;
+
+		// count call n and maybe time f()
+		template<class F>
+		auto call(std::atomic<uint64_t>& n, F f) const
+		{
+			uint64_t m = n.load(std::memory_order_relaxed);
+			n.store(m + 1, std::memory_order_relaxed);
+			if (!timed || (m & mask))
+				return f();
+
+			auto& c = probes::local()[id];
+			uint64_t b = timer::cycles();
+			auto r = f();
+			region::add(c.cycles, timer::cycles() - b);
+			region::add(c.sampled, 1);
+
+			return r;
+		}
+	public:
+		typedef typename enumerator_traits<I>::is_counted is_counted;
+		typedef block::is_fillable<I> is_fillable;
+		using enumerator<I,T,C>::i;
+
+		probe_()
+			: id(0), mask(0), timed(false)
+		{ }
+		// time every n-th call, none if n is 0
+		probe_(I i, size_t id, size_t n = 0)
+			: enumerator<I,T,C>(i), id(id), mask(probes::ceil2(n) - 1), timed(n != 0)
+		{ }
+
+		// counted enumerators only
+		template<class J = I>
+		auto size() const -> decltype(std::declval<const J&>().size())
+		{
+			return i.size();
+		}
+		size_t extent() const
+		{
+			return block::extent(i);
+		}
+		template<class U>
+		void fill(U* b, size_t n)
+		{
+			auto& c = probes::local()[id];
+			region::add(c.values, n);
+			if (!timed) {
+				block::fill(i, b, n);
+
+				return;
+			}
+			uint64_t t = timer::cycles();
+			block::fill(i, b, n);
+			region::add(c.fill_cycles, timer::cycles() - t);
+			region::add(c.filled, n);
+		}
+
+		operator bool() const
+		{
+			return call(probes::local()[id].bools, [this]() { return static_cast<bool>(i); });
+		}
+		T operator*() const
+		{
+			return call(probes::local()[id].derefs, [this]() -> T { return *i; });
+		}
+		// for I with non-const operator*
+		T operator*()
+		{
+			return call(probes::local()[id].derefs, [this]() -> T { return *i; });
+		}
+		probe_& operator++()
+		{
+			call(probes::local()[id].increments, [this]() { ++i; return true; });
+
+			return *this;
+		}
+		probe_ operator++(int)
+		{
+			probe_ p(*this);
+
+			operator++();
+
+			return p;
+		}
+		// random access I only
+		probe_& operator+=(std::ptrdiff_t n)
+		{
+			call(probes::local()[id].increments, [this,n]() { i += n; return true; });
+
+			return *this;
+		}
+		probe_& operator-=(std::ptrdiff_t n)
+		{
+			return operator+=(-n);
+		}
+		T operator[](std::ptrdiff_t n) const
+		{
+			return call(probes::local()[id].derefs, [this,n]() -> T { return i[n]; });
+		}
+	};
+	template<class I, class T, class C>
+	struct is_random_access<probe_<I,T,C>> : is_random_access<I> { };
+
+#ifdef NREGION
+	template<class I>
+	inline I probe(I i, const char*, size_t = 0)
+	{
+		return i;
+	}
+#else
+	// name must outlive the program, e.g., a literal
+	template<class I>
+	inline auto probe(I i, const char* name, size_t n = 0)
+	{
+		return probe_<I>(i, probes::id(name), n);
+	}
+#endif
+
+} // iter
+
+#ifdef _DEBUG
+#include <cstring>
+#include "include/ensure.h"
+#include "enumerator/counted.h"
+#include "fmap.h"
+#include "iota.h"
+#include "last.h"
+#include "take.h"
+#include "where.h"
+
+using namespace iter;
+
+inline probes::total test_probe_total(const char* name)
+{
+	for (const auto& t : probes::totals())
+		if (0 == strcmp(t.name, name))
+			return t;
+
+	return probes::total{name};
+}
+
+inline void test_probe()
+{
+	int a[] = {1,2,3};
+	auto p = probe(ce(a), "test_probe a");
+	static_assert(std::is_same<decltype(p)::is_counted, decltype(ce(a))::is_counted>::value, "is_counted");
+	static_assert(std::is_same<decltype(p)::iterator_category, decltype(ce(a))::iterator_category>::value, "category");
+	static_assert(std::is_same<decltype(p)::value_type, int>::value, "value_type");
+	static_assert(is_random_access<decltype(p)>::value == is_random_access<decltype(ce(a))>::value, "random access");
+	ensure (p.size() == 3);
+
+	int s = 0;
+	for (auto q = p; q; ++q)
+		s += *q;
+	ensure (s == 6);
+	ensure (p[2] == 3);
+	ensure (*(p += 1) == 2);
+
+	// a pipeline with and without probes
+	auto f = [](int n) { return take(n, iota(1)); };
+	auto w = [](const auto& i) { return *i % 3 != 0; };
+	auto e = take(100, where(w, flatten(fmap(f, iota(2)))));
+	auto ep = take(100, probe(where(w, probe(flatten(probe(fmap(f, iota(2)), "test_probe fmap")), "test_probe flatten")), "test_probe where"));
+	ensure (sum0(e) == sum0(ep));
+
+	double b[3];
+	auto c = probe(ce(a), "test_probe fill", 1);
+	ensure (c.extent() == 3);
+	c.fill(b, 2);
+	ensure (b[0] == 1 && b[1] == 2);
+	ensure (*c == 3);
+
+	auto t = probe(ce(a), "test_probe timed", 1);
+	while (t)
+		++t;
+
+	auto ta = test_probe_total("test_probe a");
+	auto tw = test_probe_total("test_probe where");
+	auto tf = test_probe_total("test_probe flatten");
+	auto tc = test_probe_total("test_probe fill");
+	auto tt = test_probe_total("test_probe timed");
+#ifdef NREGION
+	ensure (ta.bools == 0 && tw.derefs == 0);
+#else
+	ensure (ta.bools == 4 && ta.derefs == 3 + 2 && ta.increments == 3 + 1);
+	ensure (tw.derefs == 100 && tw.increments == 100);
+	ensure (tf.increments >= tw.increments);
+	ensure (tc.values == 2 && tc.filled == 2 && tc.derefs == 1 && tc.sampled == 1);
+	ensure (tt.bools == 4 && tt.increments == 3 && tt.sampled == 7);
+	ensure (ta.sampled == 0 && ta.cycles == 0);
+#endif
+
+	probes::reset();
+	ensure (test_probe_total("test_probe a").bools == 0);
+}
+
+#endif // _DEBUG
@@ -0,0 +1,199 @@
+// simd.h - values in lanes
+// simd<T,N> has lane-wise arithmetic and converts from T by broadcasting, so
+// it can be the value type of constant, pow, iota, binop, accumulate_, and
+// null enumerators. One traversal evaluates N arguments, e.g.,
+// math::exp(simd<double,4>::load(x)). Null enumerators stop when every lane has.
+// GCC and clang vector extensions keep the lanes in a register when they fit,
+// otherwise lanes are an array.
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "kernel.h"
+
+namespace iter {
+
+	namespace detail {
+
+		// bytes in the widest vector register
+#if defined(ITER_AVX512)
+		static const size_t simd_bytes = 64;
+#elif defined(ITER_AVX)
+		static const size_t simd_bytes = 32;
+#elif defined(ITER_SSE2)
+		static const size_t simd_bytes = 16;
+#else
+		static const size_t simd_bytes = 0;
+#endif
+
+		// GCC and clang vector extensions if the lanes fit in a register
+		template<class T, size_t N>
+		struct simd_vector : std::integral_constant<bool,
+#if defined(__GNUC__)
+			std::is_arithmetic<T>::value && !(N & (N - 1)) && N*sizeof(T) <= simd_bytes
+#else
+			false
+#endif
+		> { };
+
+		template<class T, size_t N, bool V = simd_vector<T,N>::value>
+		struct simd_lanes {
+			typedef T type[N];
+		};
+#if defined(__GNUC__)
+		template<class T, size_t N>
+		struct simd_lanes<T,N,true> {
+			typedef T type __attribute__((vector_size(N*sizeof(T))));
+		};
+#endif
+
+	} // detail
+
+	template<class T, size_t N>
+	struct simd {
+		typedef typename detail::simd_vector<T,N>::type is_vector;
+		typedef typename detail::simd_lanes<T,N>::type lanes;
+		lanes v;
+
+		// f(v, x.v) on vectors or f(v[k], x.v[k]) for each lane
+		template<class F>
+		simd& lanewise(const simd& x, F f, std::true_type)
+		{
+			f(v, x.v);
+
+			return *this;
+		}
+		template<class F>
+		simd& lanewise(const simd& x, F f, std::false_type)
+		{
+			for (size_t k = 0; k < N; ++k)
+				f(v[k], x.v[k]);
+
+			return *this;
+		}
+		template<class F>
+		simd& lanewise(const simd& x, F f)
+		{
+			return lanewise(x, f, is_vector{});
+		}
+
+		simd()
+		{ }
+		// broadcast
+		simd(const T& t)
+		{
+			for (size_t k = 0; k < N; ++k)
+				(*this)[k] = t;
+		}
+		// lanes p[0], ..., p[N-1]
+		static simd load(const T* p)
+		{
+			simd x;
+
+			std::memcpy(&x.v, p, sizeof(lanes));
+
+			return x;
+		}
+		// write lanes to p[0], ..., p[N-1]
+		void store(T* p) const
+		{
+			std::memcpy(p, &v, sizeof(lanes));
+		}
+
+		static constexpr size_t size()
+		{
+			return N;
+		}
+		T operator[](size_t k) const
+		{
+			return v[k];
+		}
+		T& operator[](size_t k)
+		{
+			return reinterpret_cast<T*>(&v)[k];
+		}
+
+		simd& operator+=(const simd& x)
+		{
+			return lanewise(x, [](auto& a, const auto& b) { a += b; });
+		}
+		simd& operator-=(const simd& x)
+		{
+			return lanewise(x, [](auto& a, const auto& b) { a -= b; });
+		}
+		simd& operator*=(const simd& x)
+		{
+			return lanewise(x, [](auto& a, const auto& b) { a *= b; });
+		}
+		simd& operator/=(const simd& x)
+		{
+			return lanewise(x, [](auto& a, const auto& b) { a /= b; });
+		}
+		simd& operator++()
+		{
+			return operator+=(simd(T(1)));
+		}
+		simd operator-() const
+		{
+			simd x;
+
+			return x.lanewise(*this, [](auto& a, const auto& b) { a = -b; });
+		}
+
+		// found by argument dependent lookup so T converts to simd
+		friend simd operator+(simd x, const simd& y)
+		{
+			return x += y;
+		}
+		friend simd operator-(simd x, const simd& y)
+		{
+			return x -= y;
+		}
+		friend simd operator*(simd x, const simd& y)
+		{
+			return x *= y;
+		}
+		friend simd operator/(simd x, const simd& y)
+		{
+			return x /= y;
+		}
+		// lane-wise absolute value
+		friend simd fabs(simd x)
+		{
+			for (size_t k = 0; k < N; ++k)
+				x[k] = std::fabs(x[k]);
+
+			return x;
+		}
+	};
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+
+inline void test_simd()
+{
+	using iter::simd;
+
+	double a[] = {1, -2, 3, -4};
+	auto x = simd<double,4>::load(a);
+	simd<double,4> y(2.);
+	ensure (x.size() == 4);
+	ensure (x[1] == -2 && y[3] == 2);
+
+	auto z = 1 + x*y - x/2.;
+	for (size_t k = 0; k < 4; ++k)
+		ensure (z[k] == 1 + a[k]*2 - a[k]/2);
+	++z;
+	ensure (z[0] == 1 + 2 - 0.5 + 1);
+	z = -fabs(x);
+	double b[4];
+	z.store(b);
+	ensure (b[0] == -1 && b[1] == -2 && b[2] == -3 && b[3] == -4);
+	z[2] = 5;
+	ensure (z[2] == 5 && z[3] == -4);
+}
+
+#endif // _DEBUG
@@ -5,30 +5,59 @@
 
 namespace iter {
 
+	namespace detail {
+
+		template<class N, class I>
+		inline I skipn(N n, I i, std::false_type)
+		{
+			while (i && n--)
+				++i;
+
+			return i;
+		}
+		template<class N, class I>
+		inline I skipn(N n, I i, std::true_type)
+		{
+			i += n;
+
+			return i;
+		}
+
+		template<class N, class I>
+		inline typename std::iterator_traits<I>::value_type at(N n, I i, std::false_type)
+		{
+			return *skipn(n, i, std::false_type{});
+		}
+		template<class N, class I>
+		inline typename std::iterator_traits<I>::value_type at(N n, I i, std::true_type)
+		{
+			return i[n];
+		}
+
+	} // detail
+
 	// i[n], i[n+1], ...
 	template<class N, class I>
 	inline I skipn(N n, I i)
 	{
-		while (i && n--)
-			++i;
-
-		return i;
+		return detail::skipn(n, i, is_random_access<I>{});
 	}
 	// specialize skip for counted_enumerator
 	template<class N, class I, class T = typename std::iterator_traits<I>::value_type>
 	inline auto skipn(N n, counted_enumerator<I,T> e)
 	{
 		n = std::min<size_t>(n, e.size());
-		std::advance(e.iterator(), n);
+		I i = e.iterator(); // const pointers return a copy
+		std::advance(i, n);
 
-		return counted_enumerator<I,T>(e.iterator(), e.size() - n);
+		return counted_enumerator<I,T>(i, e.size() - n);
 	}
 
 	// *i[n]
 	template<class N, class I>
 	inline typename std::iterator_traits<I>::value_type at(N n, I i)
 	{
-		return *skipn(n, i);
+		return detail::at(n, i, is_random_access<I>{});
 	}
 
 	// i[n[0]], i[n[0] + n[1]], ...
@@ -47,9 +76,10 @@ namespace iter {
 			: enumerator<I,T,C>(skipn(*n,i)), n(n)
 		{ }
 
+		// ends with n or i
 		operator bool() const
 		{
-			return i;
+			return n && i;
 		}
 		T operator*() const
 		{
@@ -107,6 +137,25 @@ inline void test_skip() {
 
 	d = skipn(100,d);
 	ensure (d.size() == 0);
+
+	// constant time for random access enumerators
+	auto f = ce(b, 6)*constant(2) + ce(b, 6);
+	ensure (*skipn(4, f) == 12);
+	ensure (at(5, f) == 15);
+	ensure (!skipn(7, f));
+	ensure (at(3, re(b + 6)) == 2);
+
+	int i[] = {1,2,2};
+	auto g = skip(ce(i), f);
+	ensure (*g == 3);
+	ensure (*++g == 9);
+	ensure (*++g == 15);
+	ensure (!++g);
+
+	// const pointers
+	const int* pb = b;
+	auto h = skipn(2, ce(pb, 6));
+	ensure (h.size() == 4 && *h == 2);
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -0,0 +1,204 @@
+// summation.h - summation policies
+// A policy S<T> is constructed from an initial value, adds values with +=,
+// and converts to T. Use with sum0<S>(e), sum<S>(e), or accumulate_.
+// Compensation is optimized away by -ffast-math.
+// sum0(e) without a policy over counted pointers to double or float uses the
+// SIMD kernel, which reassociates, so it is not a sequential sum.
+// sum0<summation::plain>(e) adds in order and is the ordered reference.
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+namespace iter {
+
+	namespace summation {
+
+		// s += x in the order given
+		template<class T>
+		class plain {
+			T s;
+		public:
+			plain(const T& s = T(0))
+				: s(s)
+			{ }
+			template<class V>
+			plain& operator+=(const V& x)
+			{
+				s += x;
+
+				return *this;
+			}
+			operator T() const
+			{
+				return s;
+			}
+		};
+
+		// carry the rounding error of each addition
+		template<class T>
+		class kahan {
+			T s, c;
+		public:
+			kahan(const T& s = T(0))
+				: s(s), c(0)
+			{ }
+			template<class V>
+			kahan& operator+=(const V& x)
+			{
+				T y = x - c;
+				T t = s + y;
+				c = (t - s) - y;
+				s = t;
+
+				return *this;
+			}
+			operator T() const
+			{
+				return s;
+			}
+		};
+
+		// Kahan-Babuska, also correct when x is larger than the sum
+		template<class T>
+		class neumaier {
+			T s, c;
+		public:
+			neumaier(const T& s = T(0))
+				: s(s), c(0)
+			{ }
+			template<class V>
+			neumaier& operator+=(const V& x_)
+			{
+				T x(x_);
+				T t = s + x;
+				if (std::fabs(s) >= std::fabs(x))
+					c += (s - t) + x;
+				else
+					c += (x - t) + s;
+				s = t;
+
+				return *this;
+			}
+			operator T() const
+			{
+				return s + c;
+			}
+		};
+
+		// binary tree of partial sums, error grows like log n
+		template<class T>
+		class pairwise {
+			T s;
+			T p[64]; // p[k] is the sum of 2^k values if bit k of n is set
+			size_t n;
+		public:
+			pairwise(const T& s = T(0))
+				: s(s), n(0)
+			{ }
+			pairwise(const pairwise& a)
+				: s(a.s), n(a.n)
+			{
+				for (size_t m = n, k = 0; m; m >>= 1, ++k)
+					p[k] = a.p[k];
+			}
+			pairwise& operator=(const pairwise& a)
+			{
+				s = a.s;
+				n = a.n;
+				for (size_t m = n, k = 0; m; m >>= 1, ++k)
+					p[k] = a.p[k];
+
+				return *this;
+			}
+			template<class V>
+			pairwise& operator+=(const V& x_)
+			{
+				T x(x_);
+				size_t k = 0;
+
+				for (size_t m = n; m & 1; m >>= 1, ++k)
+					x = p[k] + x;
+				p[k] = x;
+				++n;
+
+				return *this;
+			}
+			operator T() const
+			{
+				T t(0);
+
+				for (size_t m = n, k = 0; m; m >>= 1, ++k)
+					if (m & 1)
+						t += p[k];
+
+				return s + t;
+			}
+		};
+
+		// binary operator for accumulate_ with state S
+		template<class S>
+		struct plus {
+			template<class V>
+			S operator()(S s, const V& x) const
+			{
+				s += x;
+
+				return s;
+			}
+		};
+
+	} // summation
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+
+template<template<class> class S>
+inline double test_summation_small()
+{
+	S<double> s(1);
+
+	for (int k = 0; k < 1000; ++k)
+		s += 1e-16;
+
+	return s;
+}
+
+inline void test_summation()
+{
+	using namespace iter::summation;
+
+	ensure (test_summation_small<plain>() == 1);
+	ensure (std::fabs(test_summation_small<kahan>() - (1 + 1e-13)) < 1e-15);
+	ensure (std::fabs(test_summation_small<neumaier>() - (1 + 1e-13)) < 1e-15);
+	ensure (std::fabs(test_summation_small<pairwise>() - (1 + 1e-13)) < 1e-15);
+
+	{
+		// large cancelling terms
+		double x[] = {1, 1e100, 1, -1e100};
+		plain<double> p;
+		kahan<double> k;
+		neumaier<double> n;
+		for (auto xi : x) {
+			p += xi;
+			k += xi;
+			n += xi;
+		}
+		ensure (p == 0);
+		ensure (k == 0);
+		ensure (n == 2);
+	}
+	{
+		pairwise<double> a;
+		for (int k = 1; k <= 100; ++k)
+			a += k;
+		pairwise<double> b(a);
+		ensure (b == 5050);
+		b += 1;
+		a = b;
+		ensure (a == 5051);
+	}
+}
+
+#endif // _DEBUG
@@ -0,0 +1,107 @@
+// table.h - values of an enumerator computed at compile time
+// static constexpr auto f = table<20>(factorial());
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include "enumerator/counted.h"
+
+namespace iter {
+
+	// fixed size array usable in constant expressions
+	template<class T, size_t N>
+	struct table_ {
+		T t[N];
+
+		constexpr table_()
+			: t{}
+		{ }
+
+		constexpr size_t size() const
+		{
+			return N;
+		}
+		constexpr const T& operator[](size_t k) const
+		{
+			return t[k];
+		}
+		constexpr T& operator[](size_t k)
+		{
+			return t[k];
+		}
+		constexpr const T* begin() const
+		{
+			return t;
+		}
+		constexpr const T* end() const
+		{
+			return t + N;
+		}
+	};
+
+	// first N values of e, zero if e has fewer
+	template<size_t N, class E, class T = typename std::iterator_traits<E>::value_type>
+	constexpr table_<T,N> table(E e)
+	{
+		table_<T,N> a;
+
+		for (size_t k = 0; k < N && e; ++k, ++e)
+			a[k] = *e;
+
+		return a;
+	}
+	// counted enumerator over a table
+	template<class T, size_t N>
+	constexpr auto ce(const table_<T,N>& a)
+	{
+		return ce(a.begin(), N);
+	}
+
+} // iter
+
+#ifdef _DEBUG
+#include "include/ensure.h"
+#include "choose.h"
+#include "constant.h"
+#include "expr.h"
+#include "factorial.h"
+#include "iota.h"
+#include "last.h"
+#include "pow.h"
+#include "take.h"
+
+inline void test_table()
+{
+	using namespace iter;
+
+	static constexpr auto f = table<10>(factorial());
+	static_assert(f.size() == 10, "table size");
+	static_assert(f[0] == 1 && f[1] == 1 && f[5] == 120 && f[9] == 362880, "factorial table");
+
+	static constexpr auto b = table<7>(choose(6));
+	static_assert(b[0] == 1 && b[1] == 6 && b[2] == 15 && b[3] == 20 && b[6] == 1, "binomial row");
+	static_assert(step::sum0(choose(6)) == 64, "row sum");
+
+	static constexpr auto p = table<4>(pow(3));
+	static_assert(p[0] == 1 && p[3] == 27, "powers");
+	static_assert(table<3>(iota(5))[2] == 7, "iota");
+	static_assert(table<3>(constant(2.5))[1] == 2.5, "constant");
+
+	static_assert(step::sum0(take(4, iota(1))) == 10, "sum0");
+	static_assert(step::prod1(take(5, iota(1))) == 120, "prod1");
+	static_assert(step::back(take(5, iota(1))) == 5, "back");
+	static_assert(step::sum0(ce(f)) == 409114, "sum0 of table");
+	static_assert(step::sum0(take(3, iota(1))*c(2)) == 12, "binop");
+#ifndef ITER_NO_CONSTANT_EVALUATED
+	static_assert(sum0(take(4, iota(1))) == 10 && prod1(take(5, iota(1))) == 120, "terminals");
+	static_assert(back(take(5, iota(1))) == 5 && sum0(ce(f)) == 409114, "terminals");
+#endif
+
+	// fewer values than N
+	static constexpr auto t = table<4>(take(2, iota(1)));
+	static_assert(t[1] == 2 && t[2] == 0, "short enumerator");
+
+	ensure (sum0(ce(f)) == 409114);
+	ensure (f.end() - f.begin() == 10);
+}
+
+#endif // _DEBUG
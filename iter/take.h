@@ -1,24 +1,52 @@
 // take.h - take elements from front or back of enumerator
 #pragma once
+#include "block.h"
 #include "enumerator.h"
 #include "skip.h"
 
 namespace iter {
 
+	namespace detail {
+
+		// last n values of i
+		template<class N, class I>
+		inline I last(N n, I i, std::false_type)
+		{
+			while (iter::skipn(n, i))
+				++i;
+
+			return i;
+		}
+		// random access i with a finite extent jumps to the last n values
+		template<class N, class I>
+		inline I last(N n, I i, std::true_type)
+		{
+			size_t m = block::extent(i);
+			if (m == block::infinite)
+				return last(n, i, std::false_type{});
+			if (m > static_cast<size_t>(n))
+				i += m - n;
+
+			return i;
+		}
+		// random access with an extent
+		template<class I>
+		struct has_last : std::integral_constant<bool, is_random_access<I>::value && block::is_fillable<I>::value> { };
+
+	} // detail
+
+	// take(-n, i) needs i to end
 	template<class N, class I>
-	inline counted_enumerator<I> take(N n, I i)
+	constexpr counted_enumerator<I> take(N n, I i)
 	{
 		if (n >= 0)
 			return ce(i, n);
 
-		while (skipn(-n, i))
-			++i;
-
-		return ce(i, -n);
+		return ce(detail::last(-n, i, detail::has_last<I>{}), -n);
 	}
 	// specialize take for counted_enumerator
 	template<class N, class I, class T = typename std::iterator_traits<I>::value_type>
-	inline auto take(N n, counted_enumerator<I,T> e)
+	constexpr auto take(N n, counted_enumerator<I,T> e)
 	{
 		if (n >= 0)
 			return ce(e.iterator(), n);
@@ -34,6 +62,7 @@ namespace iter {
 
 #ifdef _DEBUG
 #include "include/ensure.h"
+#include "enumerator/reverse.h"
 
 inline void test_take() {
 	int a[] = {0,1,2};
@@ -51,6 +80,31 @@ inline void test_take() {
 	ensure (*c == 2);
 	++c;
 	ensure (!c);
+
+	auto d = take(-2, ce(a,3) + ce(a,3));
+	ensure (*d == 2);
+	++d;
+	ensure (*d == 4);
+	++d;
+	ensure (!d);
+
+	// reverse enumerators have no extent and step
+	static_assert(!iter::detail::has_last<decltype(re(a + 3))>::value, "reverse");
+	static_assert(iter::detail::has_last<decltype(ce(a, 3))>::value, "counted");
+	{
+		// random access without an extent, a counted leaf ends it
+		int b[] = {0,10,20};
+		auto r = ce(b, 3) + re(a + 3); // 2, 11, 20
+		static_assert(is_random_access<decltype(r)>::value && !iter::detail::has_last<decltype(r)>::value, "steps");
+		auto t = take(-2, r);
+		ensure (*t == 11);
+		++t;
+		ensure (*t == 20);
+		++t;
+		ensure (!t);
+		auto u = take(-5, r);
+		ensure (*u == 2);
+	}
 }
 
 #endif // _DEBUG
\ No newline at end of file
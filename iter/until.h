@@ -6,7 +6,7 @@ namespace iter {
 	template<class P, class I>
 	inline I until(P p, I i)
 	{
-		while (!p(i))
+		while (i && !p(i))
 			++i;
 
 		return i;
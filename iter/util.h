@@ -1,5 +1,7 @@
 // util.h - utilites
 #pragma once
+#include "kernel.h"
+#include "enumerator/counted.h"
 
 // e.g., pick(L(n, 2*n + 1), factorial{}, ) => (2n+1)!
 // lambda macro
@@ -12,7 +14,7 @@
 #endif
 // enumerator over n
 #ifndef E_
-#define E_(...) apply([](auto n) { return (__VA_ARGS__) ; })
+#define E_(...) iter::apply([](auto n) { return (__VA_ARGS__) ; })
 #endif
 
 namespace iter {
@@ -41,6 +43,28 @@ namespace iter {
 		return false;
 	}
 
+	// contiguous memory
+	template<class T>
+	inline bool all(counted_enumerator<T*,T> i)
+	{
+		return kernel::all(i.begin(), i.size());
+	}
+	template<class T>
+	inline bool all(counted_enumerator<const T*,T> i)
+	{
+		return kernel::all(i.begin(), i.size());
+	}
+	template<class T>
+	inline bool any(counted_enumerator<T*,T> i)
+	{
+		return kernel::any(i.begin(), i.size());
+	}
+	template<class T>
+	inline bool any(counted_enumerator<const T*,T> i)
+	{
+		return kernel::any(i.begin(), i.size());
+	}
+
 } // iter
 #ifdef _DEBUG
 #include "include/ensure.h"
@@ -53,6 +77,12 @@ inline void test_util()
 	ensure (all(b));
 	ensure (any(b));
 
+	double x[] = {1,2,3,0,5};
+	ensure (!all(iter::ce(x)));
+	ensure (all(iter::ce(x, 3)));
+	ensure (any(iter::ce(x + 3, 2)));
+	ensure (!any(iter::ce(x + 3, 1)));
+
 	auto c = L_(x, x*x);
 	ensure (c(1.2) == 1.2*1.2);
 
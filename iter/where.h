@@ -1,13 +1,19 @@
 // where.h - Filter based on a predicate
 #pragma once
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include "block.h"
+#include "callable.h"
 #include "enumerator.h"
+#include "kernel.h"
 #include "until.h"
 
 namespace iter {
 
 	template<class P, class I, class T = typename std::iterator_traits<I>::value_type>
 	class where_ : public enumerator<I,T,std::input_iterator_tag> {
-		std::function<bool(const I&)> p;
+		detail::callable<P> p;
 	public:
 		using enumerator<I,T,std::input_iterator_tag>::i;
 		typedef std::false_type is_counted;
@@ -47,10 +53,98 @@ namespace iter {
 		return where_<P,I,T>(p, i);
 	}
 
+	// values t of e with p(t) true
+	// e is evaluated a block at a time and the values kept are compressed into a buffer
+	template<class P, class E, class T = typename std::iterator_traits<E>::value_type>
+	class filter_ : public enumerator<E,T,std::input_iterator_tag> {
+		detail::callable<P> p;
+		size_t k, m;
+		std::shared_ptr<T> b; // values kept, shared by copies until one of them refills
+
+		typedef std::is_convertible<decltype(block::view(std::declval<E&>(), (T*)0, size_t(0))), const T*> is_contiguous;
+		// next n values of i, in t if they are not contiguous
+		const T* values(T* t, size_t n, std::true_type)
+		{
+			return block::view(i, t, n);
+		}
+		const T* values(T* t, size_t n, std::false_type)
+		{
+			block::fill(i, t, n);
+
+			return t;
+		}
+		// next block with at least one value kept
+		void next()
+		{
+			T t[block::size];
+			unsigned char keep[block::size];
+
+			if (!b || b.use_count() != 1)
+				b.reset(new T[block::size], std::default_delete<T[]>());
+			for (k = m = 0; m == 0; ) {
+				size_t n = std::min(block::extent(i), block::size);
+				if (n == 0)
+					break;
+				const T* v = values(t, n, is_contiguous{});
+				for (size_t j = 0; j < n; ++j)
+					keep[j] = p(v[j]);
+				m = kernel::compress(v, keep, n, b.get());
+			}
+		}
+	public:
+		using enumerator<E,T,std::input_iterator_tag>::i;
+		typedef std::false_type is_counted;
+
+		filter_()
+			: k(0), m(0)
+		{ }
+		filter_(P p, E e)
+			: enumerator<E,T,std::input_iterator_tag>(e), p(p)
+		{
+			static_assert(block::is_fillable<E>::value && !std::is_pointer<E>::value,
+				"iter::filter: e must be fillable with an extent");
+			next();
+		}
+
+		operator bool() const
+		{
+			return k < m;
+		}
+		T operator*() const
+		{
+			return b.get()[k];
+		}
+		filter_& operator++()
+		{
+			if (++k == m)
+				next();
+
+			return *this;
+		}
+		filter_ operator++(int)
+		{
+			filter_ f(*this);
+
+			operator++();
+
+			return f;
+		}
+	};
+	// like where but p is called on values instead of enumerators
+	template<class P, class E, class T = typename std::iterator_traits<E>::value_type>
+	inline auto filter(P p, E e)
+	{
+		return filter_<P,E,T>(p, e);
+	}
+
 } // iter
 
 #ifdef _DEBUG
+#include <vector>
 #include "include/ensure.h"
+#include "constant.h"
+#include "iota.h"
+#include "enumerator/counted.h"
 
 inline void test_where()
 {
@@ -63,6 +157,47 @@ inline void test_where()
 
 	auto c(b);
 	b = c;
+
+	{
+		auto d = filter([](int i) { return (i % 2) != 0; }, ce(a));
+		ensure (*d == 1);
+		ensure (*++d == 3);
+		d++;
+		ensure (*d == 5);
+		ensure (!++d);
+
+		ensure (!filter([](int i) { return i > 5; }, ce(a)));
+	}
+	{
+		// survivors spread over several blocks
+		std::vector<double> x(1000);
+		for (size_t k = 0; k < x.size(); ++k)
+			x[k] = double(k);
+		auto big = [](double t) { return t >= 600 && int(t) % 100 == 0; };
+		auto f = filter(big, ce(x.data(), x.size()));
+		auto w = where([big](const auto& t) { return big(*t); }, ce(x.data(), x.size()));
+		for (int k = 0; k < 4; ++k, ++f, ++w)
+			ensure (f && *f == *w);
+		ensure (!f);
+
+		// infinite sources
+		auto g = filter([](int i) { return i % 2 == 1; }, iota(0));
+		for (int k = 0; k < 300; ++k, ++g)
+			ensure (*g == 2*k + 1);
+
+		// constants view a repeated value, not a pointer
+		auto h = filter([](double t) { return t > 0; }, iter::c(1.));
+		for (int k = 0; k < 300; ++k, ++h)
+			ensure (*h == 1);
+
+		// copies keep their values when the original refills
+		auto e = filter([](int i) { return i % 2 == 0; }, iota(0));
+		for (int k = 0; k < 127; ++k)
+			++e;
+		auto e0 = e++;
+		ensure (*e0 == 254 && *e == 256);
+		ensure (*++e0 == 256);
+	}
 }
 
 #endif // _DEBUG
\ No newline at end of file
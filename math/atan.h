@@ -1,13 +1,442 @@
 // atan.h - arctangent
+// atan_euler(x) enumerates the terms of Euler's series
+// atan(x) = sum_0^oo (2^{2n}(n!)^2/(2n + 1)!) x^{2n+1}/(1 + x^2)^{n+1}
+// and atan_series(x) sums them for reference and for types like iter::simd.
+// Terms have ratio y 2n/(2n + 1), y = x^2/(1 + x^2), so convergence is slow for large |x|.
+// atan(x) for float and double uses atan(x) = pi/2 - atan(1/x) and
+// atan(x) = pi/4 + atan((x - 1)/(x + 1)) to reduce |x| before a fixed
+// rational (double) or polynomial (float) approximation.
+// atan(in, out, n) and atan2(y, x, out, n) use AVX2 or AVX-512 if available.
 #pragma once
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include "../iter/iter.h"
 
 namespace math {
 
-	// atan(x) = sum_0^oo (2^{2n}(n!)^2/(2n + 1)!) x^{2n+1}/(1 + x^2)^{n+1}
+	// terms of Euler's series for atan(x)
+	template<class X>
+	class atan_euler_ : public iter::enumerator<void,X,std::input_iterator_tag> {
+		X y, t, n; // x^2/(1 + x^2), current term, index
+	public:
+		atan_euler_(const X& x)
+			: y(x*x/(1 + x*x)), t(x/(1 + x*x)), n(0)
+		{ }
+
+		operator bool() const
+		{
+			return true;
+		}
+		X operator*() const
+		{
+			return t;
+		}
+		atan_euler_& operator++()
+		{
+			n += 1;
+			t *= y*(2*n)/(2*n + 1);
+
+			return *this;
+		}
+		atan_euler_ operator++(int)
+		{
+			atan_euler_ e(*this);
+
+			operator++();
+
+			return e;
+		}
+	};
+	template<class X>
+	inline atan_euler_<X> atan_euler(const X& x)
+	{
+		return atan_euler_<X>(x);
+	}
+
+	template<class X = double>
+	inline X atan_series(const X& x)
+	{
+		return X(iter::sum0(iter::ne(atan_euler(x))));
+	}
+	// stop when policy P is satisfied, e.g., atan_series(x, iter::converge::relative(1e-8))
+	template<class X, class P>
+	inline X atan_series(const X& x, const P& p)
+	{
+		return X(iter::sum0(iter::ne(atan_euler(x), p)));
+	}
+
+	namespace detail {
+
+		template<class X>
+		struct atan_traits;
+		template<>
+		struct atan_traits<double> {
+			static constexpr double big() { return 2.41421356237309504880; } // tan(3 pi/8)
+			static constexpr double mid() { return 0.66; }
+			static constexpr double pi() { return 3.14159265358979323846; }
+			static constexpr double pi2() { return 1.57079632679489661923; }
+			static constexpr double pi4() { return 0.78539816339744830962; }
+			static constexpr double more() { return 6.123233995736765886130e-17; } // pi/2 - pi2()
+		};
+		template<>
+		struct atan_traits<float> {
+			static constexpr float big() { return 2.414213562373095f; }
+			static constexpr float mid() { return 0.4142135623730950f; } // tan(pi/8)
+			static constexpr float pi() { return 3.14159265358979323846f; }
+			static constexpr float pi2() { return 1.57079632679489661923f; }
+			static constexpr float pi4() { return 0.78539816339744830962f; }
+			static constexpr float more() { return float(1.57079632679489661923 - double(pi2())); }
+		};
+
+		// atan(x) = x + x z P(z)/Q(z), z = x^2, |x| <= 0.66, Q monic
+		template<class X = double>
+		struct atan_rational {
+			static constexpr X P[] = {
+				-8.750608600031904122785e-1, -1.615753718733365076637e1, -7.500855792314704667340e1,
+				-1.228866684490136173410e2, -6.485021904942025371773e1
+			};
+			static constexpr X Q[] = {
+				2.485846490142306297962e1, 1.650270098316988542046e2, 4.328810604912902668951e2,
+				4.853903996359136964868e2, 1.945506571482613964425e2
+			};
+		};
+		template<class X>
+		constexpr X atan_rational<X>::P[];
+		template<class X>
+		constexpr X atan_rational<X>::Q[];
+
+		inline double atan_kernel(double x)
+		{
+			const auto& P = atan_rational<>::P;
+			const auto& Q = atan_rational<>::Q;
+			double z = x*x, p = P[0], q = z + Q[0];
+
+			for (size_t k = 1; k < 5; ++k) {
+				p = p*z + P[k];
+				q = q*z + Q[k];
+			}
+
+			return x + x*(z*p/q);
+		}
+		// |x| <= tan(pi/8)
+		inline float atan_kernel(float x)
+		{
+			float z = x*x;
+
+			return (((8.05374449538e-2f*z - 1.38776856032e-1f)*z + 1.99777106478e-1f)*z - 3.33329491539e-1f)*z*x + x;
+		}
+
+		template<class X>
+		inline X atan_reduced(X x)
+		{
+			typedef atan_traits<X> A;
+			X a = std::fabs(x), y = 0, m = 0;
+
+			if (a > A::big()) {
+				a = -1/a;
+				y = A::pi2();
+				m = A::more();
+			}
+			else if (a > A::mid()) {
+				a = (a - 1)/(a + 1);
+				y = A::pi4();
+				m = A::more()/2;
+			}
+
+			return std::copysign(y + (atan_kernel(a) + m), x);
+		}
+
+		template<class X>
+		inline X atan2_reduced(X y, X x)
+		{
+			// atan2(+-inf, +-inf) = atan2(+-1, +-1), atan2(+-0, +-0) = atan(+-0) plus quadrant
+			if (std::isinf(x) && std::isinf(y)) {
+				x = std::copysign(X(1), x);
+				y = std::copysign(X(1), y);
+			}
+			X t = (x == 0 && y == 0) ? std::copysign(X(0), y)*std::copysign(X(1), x) : y/x;
+			X r = atan_reduced(t);
+
+			return std::signbit(x) ? r + std::copysign(atan_traits<X>::pi(), y) : r;
+		}
+
+#if defined(ITER_AVX512)
+		inline __m512d atan8(__m512d x)
+		{
+			typedef atan_traits<double> A;
+			const auto& P = atan_rational<>::P;
+			const auto& Q = atan_rational<>::Q;
+
+			__m512i s = _mm512_and_si512(_mm512_castpd_si512(x), _mm512_set1_epi64(INT64_MIN));
+			__m512d a = _mm512_abs_pd(x), one = _mm512_set1_pd(1), zero = _mm512_setzero_pd();
+			__mmask8 big = _mm512_cmp_pd_mask(a, _mm512_set1_pd(A::big()), _CMP_GT_OQ);
+			__mmask8 mid = _mm512_cmp_pd_mask(a, _mm512_set1_pd(A::mid()), _CMP_GT_OQ) & ~big;
+			// -1/a or (a - 1)/(a + 1) in one division
+			__m512d num = _mm512_mask_blend_pd(big, _mm512_mask_blend_pd(mid, a, _mm512_sub_pd(a, one)), _mm512_set1_pd(-1));
+			__m512d den = _mm512_mask_blend_pd(big, _mm512_mask_blend_pd(mid, one, _mm512_add_pd(a, one)), a);
+			__m512d y = _mm512_mask_blend_pd(big, _mm512_mask_blend_pd(mid, zero, _mm512_set1_pd(A::pi4())), _mm512_set1_pd(A::pi2()));
+			__m512d m = _mm512_mask_blend_pd(big, _mm512_mask_blend_pd(mid, zero, _mm512_set1_pd(A::more()/2)), _mm512_set1_pd(A::more()));
+			a = _mm512_div_pd(num, den);
+
+			__m512d z = _mm512_mul_pd(a, a);
+			__m512d p = _mm512_set1_pd(P[0]), q = _mm512_add_pd(z, _mm512_set1_pd(Q[0]));
+			for (size_t k = 1; k < 5; ++k) {
+				p = _mm512_add_pd(_mm512_mul_pd(p, z), _mm512_set1_pd(P[k]));
+				q = _mm512_add_pd(_mm512_mul_pd(q, z), _mm512_set1_pd(Q[k]));
+			}
+			__m512d r = _mm512_add_pd(a, _mm512_mul_pd(a, _mm512_div_pd(_mm512_mul_pd(z, p), q)));
+			r = _mm512_add_pd(y, _mm512_add_pd(r, m));
+
+			return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(r), s));
+		}
+		inline __m512d atan2_8(__m512d y, __m512d x)
+		{
+			const __m512i sign = _mm512_set1_epi64(INT64_MIN);
+			__m512d one = _mm512_set1_pd(1), zero = _mm512_setzero_pd(), inf = _mm512_set1_pd(HUGE_VAL);
+			__m512d ax = _mm512_abs_pd(x), ay = _mm512_abs_pd(y);
+			__mmask8 zeros = _mm512_cmp_pd_mask(ax, zero, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(ay, zero, _CMP_EQ_OQ);
+			__mmask8 infs = _mm512_cmp_pd_mask(ax, inf, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(ay, inf, _CMP_EQ_OQ);
+			// +-0 or +-1 with the sign of y/x
+			__m512i sxy = _mm512_and_si512(_mm512_xor_si512(_mm512_castpd_si512(x), _mm512_castpd_si512(y)), sign);
+			__m512d t = _mm512_mask_blend_pd(infs, zero, one);
+			t = _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(t), sxy));
+			t = _mm512_mask_blend_pd(zeros | infs, _mm512_div_pd(y, x), t);
+
+			__m512d r = atan8(t);
+			__m512d pi = _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(_mm512_set1_pd(atan_traits<double>::pi())),
+				_mm512_and_si512(_mm512_castpd_si512(y), sign)));
+			__mmask8 neg = _mm512_test_epi64_mask(_mm512_castpd_si512(x), sign);
+
+			return _mm512_mask_add_pd(r, neg, r, pi);
+		}
+#endif
+#if defined(ITER_AVX2)
+		inline __m256d atan4(__m256d x)
+		{
+			typedef atan_traits<double> A;
+			const auto& P = atan_rational<>::P;
+			const auto& Q = atan_rational<>::Q;
+
+			__m256d sign = _mm256_set1_pd(-0.), one = _mm256_set1_pd(1);
+			__m256d s = _mm256_and_pd(sign, x);
+			__m256d a = _mm256_andnot_pd(sign, x);
+			__m256d big = _mm256_cmp_pd(a, _mm256_set1_pd(A::big()), _CMP_GT_OQ);
+			__m256d mid = _mm256_andnot_pd(big, _mm256_cmp_pd(a, _mm256_set1_pd(A::mid()), _CMP_GT_OQ));
+			// -1/a or (a - 1)/(a + 1) in one division
+			__m256d num = _mm256_blendv_pd(_mm256_blendv_pd(a, _mm256_sub_pd(a, one), mid), _mm256_set1_pd(-1), big);
+			__m256d den = _mm256_blendv_pd(_mm256_blendv_pd(one, _mm256_add_pd(a, one), mid), a, big);
+			__m256d y = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(A::pi2())), _mm256_and_pd(mid, _mm256_set1_pd(A::pi4())));
+			__m256d m = _mm256_or_pd(_mm256_and_pd(big, _mm256_set1_pd(A::more())), _mm256_and_pd(mid, _mm256_set1_pd(A::more()/2)));
+			a = _mm256_div_pd(num, den);
+
+			__m256d z = _mm256_mul_pd(a, a);
+			__m256d p = _mm256_set1_pd(P[0]), q = _mm256_add_pd(z, _mm256_set1_pd(Q[0]));
+			for (size_t k = 1; k < 5; ++k) {
+				p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P[k]));
+				q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q[k]));
+			}
+			__m256d r = _mm256_add_pd(a, _mm256_mul_pd(a, _mm256_div_pd(_mm256_mul_pd(z, p), q)));
+			r = _mm256_add_pd(y, _mm256_add_pd(r, m));
+
+			return _mm256_xor_pd(r, s);
+		}
+		inline __m256d atan2_4(__m256d y, __m256d x)
+		{
+			__m256d sign = _mm256_set1_pd(-0.), one = _mm256_set1_pd(1), zero = _mm256_setzero_pd(), inf = _mm256_set1_pd(HUGE_VAL);
+			__m256d ax = _mm256_andnot_pd(sign, x), ay = _mm256_andnot_pd(sign, y);
+			__m256d zeros = _mm256_and_pd(_mm256_cmp_pd(ax, zero, _CMP_EQ_OQ), _mm256_cmp_pd(ay, zero, _CMP_EQ_OQ));
+			__m256d infs = _mm256_and_pd(_mm256_cmp_pd(ax, inf, _CMP_EQ_OQ), _mm256_cmp_pd(ay, inf, _CMP_EQ_OQ));
+			// +-0 or +-1 with the sign of y/x
+			__m256d t = _mm256_or_pd(_mm256_and_pd(infs, one), _mm256_and_pd(_mm256_xor_pd(x, y), sign));
+			t = _mm256_blendv_pd(_mm256_div_pd(y, x), t, _mm256_or_pd(zeros, infs));
+
+			__m256d r = atan4(t);
+			__m256d pi = _mm256_or_pd(_mm256_set1_pd(atan_traits<double>::pi()), _mm256_and_pd(y, sign));
+
+			// blendv uses the sign bit of x
+			return _mm256_add_pd(r, _mm256_blendv_pd(zero, pi, x));
+		}
+#endif
+
+	} // detail
+
+	// argument reduction and a fixed approximation
+	inline double atan(double x)
+	{
+		return detail::atan_reduced(x);
+	}
+	inline float atan(float x)
+	{
+		return detail::atan_reduced(x);
+	}
+	// other types use the series
 	template<class X>
 	inline X atan(const X& x)
 	{
-		return 0;
+		return atan_series(x);
+	}
+	template<class X, class P>
+	inline X atan(const X& x, const P& p)
+	{
+		return atan_series(x, p);
+	}
+
+	// angle of (x, y) in [-pi, pi]
+	inline double atan2(double y, double x)
+	{
+		return detail::atan2_reduced(y, x);
+	}
+	inline float atan2(float y, float x)
+	{
+		return detail::atan2_reduced(y, x);
+	}
+
+	// out[k] = atan(in[k]), in and out may be the same
+	template<class X>
+	inline void atan(const X* in, X* out, size_t n)
+	{
+		for (size_t k = 0; k < n; ++k)
+			out[k] = atan(in[k]);
+	}
+	inline void atan(const double* in, double* out, size_t n)
+	{
+		size_t k = 0;
+
+#if defined(ITER_AVX512)
+		for (; k + 8 <= n; k += 8)
+			_mm512_storeu_pd(out + k, detail::atan8(_mm512_loadu_pd(in + k)));
+#elif defined(ITER_AVX2)
+		for (; k + 4 <= n; k += 4)
+			_mm256_storeu_pd(out + k, detail::atan4(_mm256_loadu_pd(in + k)));
+#endif
+		for (; k < n; ++k)
+			out[k] = atan(in[k]);
+	}
+
+	// out[k] = atan2(y[k], x[k])
+	template<class X>
+	inline void atan2(const X* y, const X* x, X* out, size_t n)
+	{
+		for (size_t k = 0; k < n; ++k)
+			out[k] = atan2(y[k], x[k]);
+	}
+	inline void atan2(const double* y, const double* x, double* out, size_t n)
+	{
+		size_t k = 0;
+
+#if defined(ITER_AVX512)
+		for (; k + 8 <= n; k += 8)
+			_mm512_storeu_pd(out + k, detail::atan2_8(_mm512_loadu_pd(y + k), _mm512_loadu_pd(x + k)));
+#elif defined(ITER_AVX2)
+		for (; k + 4 <= n; k += 4)
+			_mm256_storeu_pd(out + k, detail::atan2_4(_mm256_loadu_pd(y + k), _mm256_loadu_pd(x + k)));
+#endif
+		for (; k < n; ++k)
+			out[k] = atan2(y[k], x[k]);
+	}
+
+} // math
+
+#ifdef _DEBUG
+#include <limits>
+#include <random>
+#include <vector>
+#include "include/ensure.h"
+
+template<class X = double>
+inline void test_atan()
+{
+	const X eps = std::numeric_limits<X>::epsilon();
+	const X inf = std::numeric_limits<X>::infinity();
+	const X nan = std::numeric_limits<X>::quiet_NaN();
+
+	{
+		auto e = math::atan_euler(X(1));
+		ensure (*e == X(0.5));
+		ensure (std::fabs(*++e - X(1)/6) <= eps);
+		ensure (std::fabs(*++e - X(1)/15) <= eps);
+	}
+
+	ensure (math::atan(X(0)) == 0 && !std::signbit(math::atan(X(0))));
+	ensure (math::atan(-X(0)) == 0 && std::signbit(math::atan(-X(0))));
+	ensure (math::atan(inf) == X(std::atan(double(inf))));
+	ensure (math::atan(-inf) == X(std::atan(-double(inf))));
+	ensure (math::atan(nan) != math::atan(nan));
+
+	std::default_random_engine dre;
+	std::uniform_real_distribution<X> u(-20, 20), v(-30, 30);
+
+	X max = 0, smax = 0;
+	std::vector<X> x(1003), y(x.size()), z(x.size());
+	for (size_t k = 0; k < x.size(); ++k) {
+		// uniform and log uniform
+		x[k] = k%2 ? u(dre) : std::copysign(X(std::pow(10., double(v(dre)))), u(dre));
+		X e = X(std::atan(double(x[k])));
+		max = std::max(max, std::fabs(math::atan(x[k]) - e)/std::fabs(e));
+		if (std::fabs(x[k]) <= 2 && std::fabs(x[k]) >= X(0.5))
+			smax = std::max(smax, std::fabs(math::atan_series(x[k]) - e)/std::fabs(e));
+	}
+	ensure (max <= 2*eps);
+	ensure (smax <= 8*eps);
+
+	// batch agrees with scalar
+	math::atan(x.data(), y.data(), x.size());
+	for (size_t k = 0; k < x.size(); ++k)
+		ensure (std::fabs(y[k] - math::atan(x[k])) <= eps*std::fabs(y[k]));
+
+	// all quadrants
+	max = 0;
+	for (size_t k = 0; k < x.size(); ++k) {
+		y[k] = u(dre);
+		X e = X(std::atan2(double(y[k]), double(x[k])));
+		max = std::max(max, std::fabs(math::atan2(y[k], x[k]) - e)/std::fabs(e));
+	}
+	ensure (max <= 4*eps);
+	math::atan2(y.data(), x.data(), z.data(), x.size());
+	for (size_t k = 0; k < x.size(); ++k)
+		ensure (std::fabs(z[k] - math::atan2(y[k], x[k])) <= eps*std::fabs(z[k]));
+
+	// zeros, infinities, and NaN
+	X a[] = {X(0), -X(0), X(1), -X(1), inf, -inf, nan};
+	const size_t n = sizeof(a)/sizeof(*a);
+	std::vector<X> ya, xa, za(n*n);
+	for (X yi : a) {
+		for (X xi : a) {
+			ya.push_back(yi);
+			xa.push_back(xi);
+		}
+	}
+	math::atan2(ya.data(), xa.data(), za.data(), n*n);
+	for (size_t k = 0; k < n*n; ++k) {
+		X e = X(std::atan2(double(ya[k]), double(xa[k])));
+		X r = math::atan2(ya[k], xa[k]);
+		if (e != e) {
+			ensure (r != r && za[k] != za[k]);
+		}
+		else {
+			ensure (std::fabs(r - e) <= eps*std::fabs(e) && std::signbit(r) == std::signbit(e));
+			ensure (za[k] == r);
+		}
+	}
+
+	// fewer terms for less accuracy
+	for (X x : {X(-2), X(0.5), X(1)}) {
+		X tol = X(1e-6);
+		ensure (std::fabs(math::atan_series(x, iter::converge::relative(tol)) - std::atan(x)) <= 10*tol);
+		auto s = series(ne(math::atan_euler(x), iter::converge::relative(tol)));
+		auto s_ = series(ne(math::atan_euler(x)));
+		ensure (s.count < s_.count);
+	}
+
+	// one traversal for several arguments
+	{
+		typedef iter::simd<X,4> X4;
+		X b[] = {X(0.1), X(0.5), X(-1), X(2)};
+		X4 t = math::atan(X4::load(b));
+		for (size_t k = 0; k < 4; ++k)
+			ensure (std::fabs(t[k] - math::atan(b[k])) <= 8*eps);
 	}
+}
 
-} //math
\ No newline at end of file
+#endif // _DEBUG
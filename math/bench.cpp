@@ -0,0 +1,45 @@
+// bench.cpp - time math functions against libm
+// ./bench [--csv] [--quick] [name ...], times are per value
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "include/bench.h"
+#include "math.h"
+
+using bench::keep;
+using bench::report;
+
+int main(int argc, char* argv[])
+{
+	bench::init(argc, argv);
+
+	const size_t n = 4096;
+	std::default_random_engine dre;
+	std::uniform_real_distribution<> u(-18, 18);
+	std::vector<double> x(n), y(n), z(n);
+	for (auto& xi : x)
+		xi = u(dre);
+	for (auto& zi : z)
+		zi = u(dre);
+
+	// exp on [-18, 18]
+	report("std::exp", [&]() { for (size_t k = 0; k < n; ++k) y[k] = std::exp(x[k]); keep(y[0]); }, n);
+	report("math::exp_series", [&]() { for (size_t k = 0; k < n; ++k) y[k] = math::exp_series(x[k]); keep(y[0]); }, n);
+	report("math::exp", [&]() { for (size_t k = 0; k < n; ++k) y[k] = math::exp(x[k]); keep(y[0]); }, n);
+	report("math::exp batch", [&]() { math::exp(x.data(), y.data(), n); keep(y[0]); }, n);
+
+	// atan and atan2 on [-20, 20]
+	for (auto& xi : x)
+		xi *= 20./18;
+	for (auto& zi : z)
+		zi *= 20./18;
+	report("std::atan", [&]() { for (size_t k = 0; k < n; ++k) y[k] = std::atan(x[k]); keep(y[0]); }, n);
+	report("math::atan", [&]() { for (size_t k = 0; k < n; ++k) y[k] = math::atan(x[k]); keep(y[0]); }, n);
+	report("math::atan batch", [&]() { math::atan(x.data(), y.data(), n); keep(y[0]); }, n);
+	report("std::atan2", [&]() { for (size_t k = 0; k < n; ++k) y[k] = std::atan2(z[k], x[k]); keep(y[0]); }, n);
+	report("math::atan2", [&]() { for (size_t k = 0; k < n; ++k) y[k] = math::atan2(z[k], x[k]); keep(y[0]); }, n);
+	report("math::atan2 batch", [&]() { math::atan2(z.data(), x.data(), y.data(), n); keep(y[0]); }, n);
+
+	return 0;
+}
@@ -1,14 +1,343 @@
 // exp.h - Exponential function
+// exp(x) for float and double reduces x = k ln 2 + r, |r| <= ln 2/2, and
+// evaluates a minimax polynomial for exp(r) by Estrin's scheme times 2^k.
+// exp(in, out, n) does the same for arrays using SSE2, AVX2, or AVX-512.
+// exp_series(x) sums the Taylor series for reference and for types like iter::simd.
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include "../iter/iter.h"
 
 namespace math {
 
-	// sum_0 x^n/n!
+	// sum_0 x^n/n!, loses relative accuracy for x < 0
 	template<class X = double>
+	inline X exp_series(const X& x)
+	{
+		return X(1 + iter::sum0(iter::ne(iter::prod(iter::c(x)/iter::iota(X(1))))));
+	}
+	// stop when policy P is satisfied, e.g., exp_series(x, iter::converge::relative(1e-8))
+	template<class X, class P>
+	inline X exp_series(const X& x, const P& p)
+	{
+		return X(1 + iter::sum0(iter::ne(iter::prod(iter::c(x)/iter::iota(X(1))), p)));
+	}
+
+	namespace detail {
+
+		template<class X>
+		struct exp_traits;
+		template<>
+		struct exp_traits<double> {
+			typedef int64_t I;
+			static const int bits = 52, bias = 1023;
+			static const size_t degree = 11; // relative error 3.1e-18 for |r| <= ln 2/2
+			static constexpr double lo() { return -746; } // exp is 0 or inf beyond
+			static constexpr double hi() { return 710; }
+			static constexpr double normal_lo() { return -708; } // 2^k is normal between
+			static constexpr double normal_hi() { return 709; }
+			static constexpr double log2e() { return 1.44269504088896340736; }
+			static constexpr double ln2hi() { return 6.93147180369123816490e-01; } // k ln2hi is exact
+			static constexpr double ln2lo() { return 1.90821492927058770002e-10; }
+			static constexpr double round() { return 6755399441055744.; } // 1.5 2^52
+			// minimax coefficients by the Remez algorithm, not 1/n!
+			static const double* c()
+			{
+				static constexpr double c[degree + 1] = {
+					1., 1., 0.5000000000000018, 0.1666666666666617,
+					0.04166666666649263, 0.008333333333559451, 0.0013888888951261204, 0.00019841269432434438,
+					2.48014864812835e-05, 2.7557622652024487e-06, 2.7632308224452543e-07, 2.4994293345730463e-08
+				};
+
+				return c;
+			}
+		};
+		template<>
+		struct exp_traits<float> {
+			typedef int32_t I;
+			static const int bits = 23, bias = 127;
+			static const size_t degree = 6; // relative error 1.9e-9
+			static constexpr float lo() { return -104; }
+			static constexpr float hi() { return 89; }
+			static constexpr float normal_lo() { return -87; }
+			static constexpr float normal_hi() { return 88; }
+			static constexpr float log2e() { return 1.44269504088896340736f; }
+			static constexpr float ln2hi() { return 0.693145751953125f; }
+			static constexpr float ln2lo() { return 1.428606765330187045e-06f; }
+			static constexpr float round() { return 12582912.f; } // 1.5 2^23
+			static const float* c()
+			{
+				static constexpr float c[degree + 1] = {
+					1.f, 1.f, 0.499999911f, 0.166664198f, 0.0416682251f, 0.00837482419f, 0.00138368353f
+				};
+
+				return c;
+			}
+		};
+
+		// c[0] + c[1] r + ... + c[D] r^D by Estrin's scheme
+		// Pairs of terms are independent, so the dependent chain is about
+		// lg D multiply adds instead of D for Horner. O has set, mul, and madd on Y.
+		template<size_t D, class O, class Y, class X>
+		inline Y estrin(Y r, const X* c)
+		{
+			Y p[D + 1];
+
+			for (size_t k = 0; k <= D; ++k)
+				p[k] = O::set(c[k]);
+			for (size_t n = D + 1; n > 1; n = (n + 1)/2) {
+				for (size_t k = 0; 2*k < n; ++k)
+					p[k] = 2*k + 1 < n ? O::madd(p[2*k + 1], r, p[2*k]) : p[2*k];
+				r = O::mul(r, r);
+			}
+
+			return p[0];
+		}
+		template<class X>
+		struct scalar_ops {
+			static X set(X a)
+			{
+				return a;
+			}
+			static X mul(X a, X b)
+			{
+				return a*b;
+			}
+			static X madd(X a, X b, X c)
+			{
+				return a*b + c;
+			}
+		};
+
+		// 2^k for normal values
+		template<class X>
+		inline X pow2(typename exp_traits<X>::I k)
+		{
+			typedef exp_traits<X> E;
+			typename E::I b = (k + E::bias) << E::bits;
+			X x;
+
+			std::memcpy(&x, &b, sizeof(X));
+
+			return x;
+		}
+
+		// exp(r) for |r| <= ln 2/2 as c[0] + r(c[1] + r t) with t by Estrin's scheme,
+		// only the last two steps round at the size of the result
+		template<class X, class O, class Y>
+		inline Y exp_poly(Y r)
+		{
+			typedef exp_traits<X> E;
+			const X* c = E::c();
+			Y t = estrin<E::degree - 2, O>(r, c + 2);
+
+			return O::madd(O::madd(t, r, O::set(c[1])), r, O::set(c[0]));
+		}
+		template<class X>
+		inline X exp_kernel(X r)
+		{
+			return exp_poly<X, scalar_ops<X>>(r);
+		}
+
+		// NaN, subnormal, and overflow results
+		template<class X>
+		inline X exp_extreme(X x)
+		{
+			typedef exp_traits<X> E;
+
+			if (x != x)
+				return x;
+
+			x = std::min(std::max(x, E::lo()), E::hi());
+			X k = (x*E::log2e() + E::round()) - E::round(); // nearest integer
+			X r = (x - k*E::ln2hi()) - k*E::ln2lo();
+			typename E::I n = static_cast<typename E::I>(k);
+			typename E::I n1 = n >> 1; // 2^n = 2^n1 2^(n - n1)
+
+			return exp_kernel(r)*pow2<X>(n1)*pow2<X>(n - n1);
+		}
+		template<class X>
+		inline X exp_reduced(X x)
+		{
+			typedef exp_traits<X> E;
+
+			if (!(x >= E::normal_lo() && x <= E::normal_hi()))
+				return exp_extreme(x);
+
+			// x log2e + 1.5 2^bits has the nearest integer n in its low bits
+			X kr = x*E::log2e() + E::round();
+			X k = kr - E::round();
+			X r = (x - k*E::ln2hi()) - k*E::ln2lo();
+			typename E::I n, b;
+			X round = E::round();
+			std::memcpy(&n, &kr, sizeof(X));
+			std::memcpy(&b, &round, sizeof(X));
+
+			return exp_kernel(r)*pow2<X>(n - b);
+		}
+
+#if defined(ITER_AVX512)
+		struct avx512_ops {
+			static __m512d set(double a)
+			{
+				return _mm512_set1_pd(a);
+			}
+			static __m512d mul(__m512d a, __m512d b)
+			{
+				return _mm512_mul_pd(a, b);
+			}
+			static __m512d madd(__m512d a, __m512d b, __m512d c)
+			{
+				return _mm512_fmadd_pd(a, b, c);
+			}
+		};
+		inline __m512d exp8(__m512d x)
+		{
+			typedef exp_traits<double> E;
+
+			// max and min return the second operand if either is NaN
+			x = _mm512_min_pd(_mm512_set1_pd(E::hi()), _mm512_max_pd(_mm512_set1_pd(E::lo()), x));
+			__m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(E::log2e())), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m512d r = _mm512_sub_pd(_mm512_sub_pd(x, _mm512_mul_pd(k, _mm512_set1_pd(E::ln2hi()))), _mm512_mul_pd(k, _mm512_set1_pd(E::ln2lo())));
+
+			return _mm512_scalef_pd(exp_poly<double, avx512_ops>(r), k);
+		}
+#endif
+#if defined(ITER_AVX2)
+		inline __m256d pow2(__m128i k)
+		{
+			__m256i b = _mm256_add_epi64(_mm256_cvtepi32_epi64(k), _mm256_set1_epi64x(exp_traits<double>::bias));
+
+			return _mm256_castsi256_pd(_mm256_slli_epi64(b, exp_traits<double>::bits));
+		}
+		struct avx2_ops {
+			static __m256d set(double a)
+			{
+				return _mm256_set1_pd(a);
+			}
+			static __m256d mul(__m256d a, __m256d b)
+			{
+				return _mm256_mul_pd(a, b);
+			}
+			static __m256d madd(__m256d a, __m256d b, __m256d c)
+			{
+#ifdef ITER_FMA
+				return _mm256_fmadd_pd(a, b, c);
+#else
+				return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+			}
+		};
+		inline __m256d exp4(__m256d x)
+		{
+			typedef exp_traits<double> E;
+
+			// max and min return the second operand if either is NaN
+			x = _mm256_min_pd(_mm256_set1_pd(E::hi()), _mm256_max_pd(_mm256_set1_pd(E::lo()), x));
+			__m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(E::log2e())), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(k, _mm256_set1_pd(E::ln2hi()))), _mm256_mul_pd(k, _mm256_set1_pd(E::ln2lo())));
+			__m256d p = exp_poly<double, avx2_ops>(r);
+
+			__m128i n = _mm256_cvtpd_epi32(k);
+			__m128i n1 = _mm_srai_epi32(n, 1);
+
+			return _mm256_mul_pd(_mm256_mul_pd(p, pow2(n1)), pow2(_mm_sub_epi32(n, n1)));
+		}
+#endif
+#if defined(ITER_SSE2)
+		struct sse2_ops {
+			static __m128d set(double a)
+			{
+				return _mm_set1_pd(a);
+			}
+			static __m128d mul(__m128d a, __m128d b)
+			{
+				return _mm_mul_pd(a, b);
+			}
+			static __m128d madd(__m128d a, __m128d b, __m128d c)
+			{
+				return _mm_add_pd(_mm_mul_pd(a, b), c);
+			}
+		};
+		// false if a lane is NaN or 2^k is not normal
+		inline bool exp2_normal(__m128d x)
+		{
+			__m128d in = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(-708.)), _mm_cmple_pd(x, _mm_set1_pd(709.)));
+
+			return _mm_movemask_pd(in) == 3;
+		}
+		// x*log2e + 1.5 2^52 has k in its low bits
+		inline __m128d exp2(__m128d x)
+		{
+			typedef exp_traits<double> E;
+
+			__m128d kr = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(E::log2e())), _mm_set1_pd(E::round()));
+			__m128d k = _mm_sub_pd(kr, _mm_set1_pd(E::round()));
+			__m128d r = _mm_sub_pd(_mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(E::ln2hi()))), _mm_mul_pd(k, _mm_set1_pd(E::ln2lo())));
+			__m128i n = _mm_sub_epi64(_mm_castpd_si128(kr), _mm_castpd_si128(_mm_set1_pd(E::round())));
+			__m128d p2 = _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(n, _mm_set1_epi64x(E::bias)), E::bits));
+
+			return _mm_mul_pd(exp_poly<double, sse2_ops>(r), p2);
+		}
+#endif
+
+	} // detail
+
+	// range reduction and a fixed degree polynomial
+	inline double exp(double x)
+	{
+		return detail::exp_reduced(x);
+	}
+	inline float exp(float x)
+	{
+		return detail::exp_reduced(x);
+	}
+	// other types use the series
+	template<class X>
 	inline X exp(const X& x)
 	{
-		return X(1 + sum0(ne(prod(c(x)/iota(X(1))))));
+		return exp_series(x);
+	}
+	template<class X, class P>
+	inline X exp(const X& x, const P& p)
+	{
+		return exp_series(x, p);
+	}
+
+	// out[k] = exp(in[k]), in and out may be the same
+	template<class X>
+	inline void exp(const X* in, X* out, size_t n)
+	{
+		for (size_t k = 0; k < n; ++k)
+			out[k] = exp(in[k]);
+	}
+	inline void exp(const double* in, double* out, size_t n)
+	{
+		size_t k = 0;
+
+#if defined(ITER_AVX512)
+		for (; k + 8 <= n; k += 8)
+			_mm512_storeu_pd(out + k, detail::exp8(_mm512_loadu_pd(in + k)));
+#elif defined(ITER_AVX2)
+		for (; k + 4 <= n; k += 4)
+			_mm256_storeu_pd(out + k, detail::exp4(_mm256_loadu_pd(in + k)));
+#elif defined(ITER_SSE2)
+		for (; k + 2 <= n; k += 2) {
+			__m128d x = _mm_loadu_pd(in + k);
+			if (detail::exp2_normal(x)) {
+				_mm_storeu_pd(out + k, detail::exp2(x));
+			}
+			else {
+				out[k] = exp(in[k]);
+				out[k + 1] = exp(in[k + 1]);
+			}
+		}
+#endif
+		for (; k < n; ++k)
+			out[k] = exp(in[k]);
 	}
 
 } // math
@@ -16,44 +345,90 @@ namespace math {
 #ifdef _DEBUG
 #include <ctime>
 #include <random>
+#include <vector>
 #include "include/ensure.h"
-#include "include/timer.h"
 
 template<class X = double>
 inline void test_exp()
 {
-	long long c;
-	auto 
-	ms = timer::time([]() { exp(1.0); }, 10000);
-	c = ms.count();
-	ms = timer::time([]() { math::exp(1.0); }, 1000);
-	c = ms.count();
+	const X eps = std::numeric_limits<X>::epsilon();
 
 	X e1 = math::exp(X(1));
 	X e1_ = exp(X(1));
-	ensure (fabs(e1 - e1_) <= 2*std::numeric_limits<X>::epsilon());
+	ensure (std::fabs(e1 - e1_) <= 2*eps);
+	ensure (std::fabs(math::exp_series(X(1)) - e1_) <= 2*eps);
+	ensure (math::exp(X(0)) == 1 && math::exp(-X(0)) == 1);
 
 	std::default_random_engine dre;
-	std::uniform_real_distribution<X> u(-18,18); //
+	std::uniform_real_distribution<X> u(-18,18);
 
 	dre.seed(static_cast<unsigned long>(std::time(nullptr)));
 
-	X max = -std::numeric_limits<X>::max();
-	X min = std::numeric_limits<X>::max();
-	for (int i = 0; i < 1000; ++i) {
-		X x = u(dre);
-//		X x = X(i);
-		X me = math::exp(x);
-		X e = exp(x);
-		X de = me - e;
-
-		if (de/e < min)
-			min = de/e;
-		if (de/e > max)
-			max = de/e;
-	}
-	ensure (0*max < 10*std::numeric_limits<X>::epsilon());
-	ensure (0*min > -12*std::numeric_limits<X>::epsilon());
+	X max = 0, smax = 0;
+	std::vector<X> x(1003), y(x.size());
+	for (auto& xi : x) {
+		xi = u(dre);
+		X e = X(exp(double(xi)));
+		max = std::max(max, std::fabs(math::exp(xi) - e)/e);
+		if (xi >= 0)
+			smax = std::max(smax, std::fabs(math::exp_series(xi) - e)/e);
+	}
+	ensure (max <= 2*eps);
+	ensure (smax <= 8*eps);
+
+	// batch agrees with scalar
+	math::exp(x.data(), y.data(), x.size());
+	for (size_t k = 0; k < x.size(); ++k)
+		ensure (std::fabs(y[k] - math::exp(x[k])) <= eps*y[k]);
+
+	// overflow, underflow, subnormal, NaN
+	X z[] = {X(1000), X(-1000), std::numeric_limits<X>::quiet_NaN(), std::numeric_limits<X>::infinity(), -std::numeric_limits<X>::infinity(),
+		std::log(std::numeric_limits<X>::max()) - 1, std::log(std::numeric_limits<X>::min()) - 2, X(0), X(1), X(2)};
+	X w[10];
+	math::exp(z, w, 10);
+	for (size_t k = 0; k < 10; ++k) {
+		X e = X(exp(double(z[k])));
+		X wk = math::exp(z[k]);
+		if (e != e) {
+			ensure (wk != wk && w[k] != w[k]);
+		}
+		else if (std::isinf(e)) {
+			ensure (wk == e && w[k] == e);
+		}
+		else {
+			X d = 2*eps*e + std::numeric_limits<X>::denorm_min();
+			ensure (std::fabs(wk - e) <= d);
+			ensure (std::fabs(w[k] - e) <= d);
+		}
+	}
+
+	// fewer terms for less accuracy
+	for (X x : {X(-10), X(-1), X(1), X(10)}) {
+		X tol = X(1e-6);
+		ensure (fabs(math::exp_series(x, iter::converge::relative(tol)) - exp(x)) <= 2*tol*exp(fabs(x)));
+		auto s = series(ne(prod(iter::c(x)/iota(X(1))), iter::converge::relative(tol)));
+		auto s_ = series(ne(prod(iter::c(x)/iota(X(1)))));
+		ensure (s.count < s_.count);
+	}
+
+	// one traversal for several arguments, lanes stop when all have converged
+	{
+		typedef iter::simd<X,4> X4;
+		X a[] = {X(0), X(0.5), X(-1), X(2)};
+		X4 x = X4::load(a);
+		X4 e = math::exp(x);
+		for (size_t k = 0; k < 4; ++k)
+			ensure (fabs(e[k] - math::exp(a[k])) <= 2*eps*math::exp(a[k]));
+
+		auto s = series(ne(prod(iter::c(x)/iota(X4(1)))));
+		ensure (s.count == series(ne(prod(iter::c(a[3])/iota(X(1))))).count);
+		auto r = series(ne(prod(iter::c(x)/iota(X4(1))), iter::converge::relative(X4(X(1e-4)))));
+		ensure (r.count < s.count);
+		ensure (r.error[0] == 0 && r.error[3] < X(1e-3));
+
+		X4 p = sum0(take(3, pow(x)));
+		ensure (p[3] == 1 + 2 + 4 && p[1] == X(1.75));
+	}
 }
 
 #endif // _DEBUG
\ No newline at end of file
@@ -1,9 +1,68 @@
 // math.cpp - test math project
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "include/bench.h"
 #include "math.h"
 
+using bench::keep;
+
+// maximum relative error of y against e and median ns per value of f() computing y.size() values
+template<class F>
+inline void report(const char* name, const std::vector<double>& y, const std::vector<double>& e, F f)
+{
+	double max = 0;
+	for (size_t k = 0; k < y.size(); ++k)
+		max = std::max(max, std::fabs(y[k] - e[k])/std::fabs(e[k]));
+	bench::options o;
+	o.samples = 5;
+	auto s = bench::run(f, y.size(), o);
+
+	printf("%-20s %6.2f eps %8.2f ns\n", name, max/std::numeric_limits<double>::epsilon(), s.median);
+}
+
+// accuracy and speed of atan and atan2 against libm
+inline void report_atan()
+{
+	const size_t n = 4096;
+	std::default_random_engine dre;
+	std::uniform_real_distribution<> u(-20, 20);
+	std::vector<double> x(n), y(n), e(n), z(n);
+	for (size_t k = 0; k < n; ++k) {
+		x[k] = u(dre);
+		y[k] = u(dre);
+	}
+
+	for (size_t k = 0; k < n; ++k)
+		e[k] = std::atan(x[k]);
+	report("std::atan", e, e, [&]() { for (size_t k = 0; k < n; ++k) z[k] = std::atan(x[k]); keep(z[0]); });
+	for (size_t k = 0; k < n; ++k)
+		z[k] = math::atan(x[k]);
+	report("math::atan", z, e, [&]() { for (size_t k = 0; k < n; ++k) z[k] = math::atan(x[k]); keep(z[0]); });
+	math::atan(x.data(), z.data(), n);
+	report("math::atan batch", z, e, [&]() { math::atan(x.data(), z.data(), n); keep(z[0]); });
+	for (size_t k = 0; k < n; ++k)
+		z[k] = math::atan_series(x[k]/20); // slow for large |x|
+	for (size_t k = 0; k < n; ++k)
+		e[k] = std::atan(x[k]/20);
+	report("math::atan_series", z, e, [&]() { for (size_t k = 0; k < n; ++k) z[k] = math::atan_series(x[k]/20); keep(z[0]); });
+
+	for (size_t k = 0; k < n; ++k)
+		e[k] = std::atan2(y[k], x[k]);
+	report("std::atan2", e, e, [&]() { for (size_t k = 0; k < n; ++k) z[k] = std::atan2(y[k], x[k]); keep(z[0]); });
+	for (size_t k = 0; k < n; ++k)
+		z[k] = math::atan2(y[k], x[k]);
+	report("math::atan2", z, e, [&]() { for (size_t k = 0; k < n; ++k) z[k] = math::atan2(y[k], x[k]); keep(z[0]); });
+	math::atan2(y.data(), x.data(), z.data(), n);
+	report("math::atan2 batch", z, e, [&]() { math::atan2(y.data(), x.data(), z.data(), n); keep(z[0]); });
+}
+
 int main()
 {
 	try {
+		test_atan<double>();
+		test_atan<float>();
 		test_exp<double>();
 		test_exp<float>();
 	}
@@ -11,5 +70,7 @@ int main()
 		return -1;
 	}
 
+	report_atan();
+
 	return 0;
-}
\ No newline at end of file
+}
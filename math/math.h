@@ -4,4 +4,5 @@
 #pragma warning(disable: 4800) // warning C4800: 'int' : forcing value to bool 'true' or 'false' (performance warning)
 #endif 
 
+#include "atan.h"
 #include "exp.h"
\ No newline at end of file
@@ -1,6 +1,10 @@
 // bell.h - Complete Bell polynomials
 #pragma once
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
 #include <vector>
+#include "include/region.h"
 #include "iter/iter.h"
 
 namespace poly {
@@ -9,6 +13,8 @@ namespace poly {
 	template<class Y, class X = double>
 	X Bell(size_t n, Y x)
 	{
+		REGION("poly::Bell");
+
 		if (n == 0)
 			return 1;
 
@@ -16,12 +22,210 @@ namespace poly {
 		b[0] = X(1);
 
 		for (size_t k = 1; k <= n; ++k)
-			b[k] = sum0(choose(k-1) * re(&b[k]) * x);
+			b[k] = iter::sum0(iter::choose(k-1) * iter::re(&b[k]) * x);
 
 		return b[n];
 	}
 
-} // bell
+	// B(0), B(1,x[0]), ..., B(N-1,x[0],...,x[N-2]) at compile time
+	// Bells<N>(iter::c(1.)) are the Bell numbers
+	template<size_t N, class Y, class X = typename std::iterator_traits<Y>::value_type>
+	constexpr iter::table_<X,N> Bells(Y x)
+	{
+		iter::table_<X,N> b;
+
+		if (N > 0)
+			b[0] = X(1);
+		for (size_t k = 1; k < N; ++k) {
+			auto c = iter::choose(k - 1);
+			Y xj(x);
+			for (size_t j = 0; j < k; ++j, ++c, ++xj)
+				b[k] += *c * b[k - 1 - j] * *xj;
+		}
+
+		return b;
+	}
+
+	// B(0), B(1,x[0]), ..., B(n,x[0],...,x[n-1]) extended one x at a time
+	// All storage is allocated up front or owned by the caller. Pascal's
+	// triangle is computed once, so push(x) is O(n) and assign(x, n) O(n^2).
+	template<class X = double>
+	class bell_table {
+		size_t max, n;
+		std::unique_ptr<X[]> own;
+		X *c, *b, *x; // choose(k, j) at c[k(k + 1)/2 + j], B(k), x[k]
+
+		void init(X* s)
+		{
+			c = s;
+			b = c + max*(max + 1)/2;
+			x = b + max + 1;
+			for (size_t k = 0; k < max; ++k) {
+				X* ck = c + k*(k + 1)/2;
+				const X* c1 = ck - k; // row k - 1
+				ck[0] = ck[k] = X(1);
+				for (size_t j = 1; j < k; ++j)
+					ck[j] = c1[j - 1] + c1[j];
+			}
+			b[0] = X(1);
+		}
+	public:
+		// number of X needed by a table of order max
+		static constexpr size_t storage(size_t max)
+		{
+			return max*(max + 1)/2 + 2*max + 1;
+		}
+		bell_table(size_t max)
+			: max(max), n(0), own(new X[storage(max)])
+		{
+			init(own.get());
+		}
+		// s points to storage(max) values that outlive the table
+		bell_table(size_t max, X* s)
+			: max(max), n(0)
+		{
+			init(s);
+		}
+		bell_table(const bell_table&) = delete;
+		bell_table& operator=(const bell_table&) = delete;
+
+		// highest order computed
+		size_t size() const
+		{
+			return n;
+		}
+		size_t capacity() const
+		{
+			return max;
+		}
+		// B(k, x[0], ..., x[k-1]) for k <= size()
+		const X& operator[](size_t k) const
+		{
+			return b[k];
+		}
+		const X& back() const
+		{
+			return b[n];
+		}
+		// B(n + 1) = sum { choose(n, j) B(n - j) x[j] : 0 <= j <= n }
+		const X& push(const X& xn)
+		{
+			if (n == max)
+				throw std::length_error("poly::bell_table::push: table is full");
+
+			const X* cn = c + n*(n + 1)/2;
+			x[n] = xn;
+			X s(0);
+			for (size_t j = 0; j <= n; ++j)
+				s += cn[j]*b[n - j]*x[j];
+			b[++n] = s;
+
+			return b[n];
+		}
+		// forget orders above k
+		void truncate(size_t k)
+		{
+			if (k < n)
+				n = k;
+		}
+		// B(0), ..., B(m) for new x[0], ..., x[m-1]
+		template<class Y>
+		const X& assign(Y y, size_t m)
+		{
+			n = 0;
+			for (size_t k = 0; k < m; ++k, ++y)
+				push(*y);
+
+			return back();
+		}
+	};
+
+	// partial Bell polynomials B(n, k, x[0], ..., x[n-k]) for 0 <= k <= n <= N
+	// at B[n(n + 1)/2 + k], one contiguous triangle of (N + 1)(N + 2)/2 values
+	// B(n, k) = sum { choose(n - 1, i - 1) x[i - 1] B(n - i, k - 1) : 1 <= i <= n - k + 1 }
+	template<class X>
+	inline void partial_bell(size_t N, const X* x, X* B)
+	{
+		B[0] = X(1);
+		for (size_t n = 1; n <= N; ++n) {
+			X* Bn = B + n*(n + 1)/2;
+			std::fill(Bn, Bn + n + 1, X(0));
+			X c(1); // choose(n - 1, i - 1)
+			for (size_t i = 1; i <= n; ++i) {
+				// rows n - i and n are read and written in order
+				const X* Bi = B + (n - i)*(n - i + 1)/2;
+				X cx = c*x[i - 1];
+				for (size_t k = 1; k <= n - i + 1; ++k)
+					Bn[k] += cx*Bi[k - 1];
+				c = c*X(n - i)/X(i);
+			}
+		}
+	}
+	// owns the triangle
+	template<class X = double>
+	class bell_triangle {
+		size_t N;
+		std::vector<X> x, B;
+	public:
+		bell_triangle(size_t N)
+			: N(N), x(N), B((N + 1)*(N + 2)/2)
+		{ }
+		template<class Y>
+		bell_triangle(size_t N, Y x)
+			: bell_triangle(N)
+		{
+			assign(x);
+		}
+
+		size_t size() const
+		{
+			return N + 1;
+		}
+		// y[0], ..., y[N-1] without allocating
+		template<class Y>
+		void assign(Y y)
+		{
+			for (size_t i = 0; i < N; ++i, ++y)
+				x[i] = *y;
+			partial_bell(N, x.data(), B.data());
+		}
+		const X& operator()(size_t n, size_t k) const
+		{
+			return B[n*(n + 1)/2 + k];
+		}
+		const X* data() const
+		{
+			return B.data();
+		}
+	};
+
+	// derivatives of f(g(x)) from f^(k)(g(x)) and g^(k)(x) for 0 <= k <= n
+	// h[m] = sum { f[k] B(m, k, g[1], ..., g[m-k+1]) : 1 <= k <= m }
+	// B is scratch for (n + 1)(n + 2)/2 values
+	template<class X>
+	inline void faa_di_bruno(size_t n, const X* f, const X* g, X* h, X* B)
+	{
+		partial_bell(n, g + 1, B);
+		h[0] = f[0];
+		for (size_t m = 1; m <= n; ++m) {
+			const X* Bm = B + m*(m + 1)/2;
+			X s(0);
+			for (size_t k = 1; k <= m; ++k)
+				s += f[k]*Bm[k];
+			h[m] = s;
+		}
+	}
+	template<class X>
+	inline std::vector<X> faa_di_bruno(size_t n, const X* f, const X* g)
+	{
+		std::vector<X> h(n + 1), B((n + 1)*(n + 2)/2);
+
+		faa_di_bruno(n, f, g, h.data(), B.data());
+
+		return h;
+	}
+
+} // poly
 
 #ifdef _DEBUG
 #include <algorithm>
@@ -49,6 +253,9 @@ inline void test_bell()
 	ensure (Bell<>(6, &x[0]) == 203);
 	ensure (Bell<>(7, &x[0]) == 877);
 	ensure (Bell<>(8, &x[0]) == 4140);
+	auto B = poly::Bells<9>(&x[0]);
+	for (size_t n = 0; n < B.size(); ++n)
+		ensure (B[n] == Bell<>(n, &x[0]));
 
 	// B(0) = 1, B(1,x1) = x1
 	ensure (Bell<>(0, iota(1)) == 1);
@@ -73,6 +280,61 @@ inline void test_bell()
 //	ensure (Bell<>(5, iota(1)) == 1 + 10*2 + 10*3 + 15*2*2 + 5*4 + 4*2*3 + 5);
 
 //	generate(begin(x), end(x), [&dre,u](void) { return u(dre); });
+
+	// incremental table agrees with Bell
+	poly::bell_table<> t(20);
+	for (size_t n = 1; n <= 8; ++n)
+		ensure (t.push(1) == Bell<>(n, &x[0]));
+	ensure (t.size() == 8 && t[5] == 52);
+
+	vector<double> y(20);
+	generate(y.begin(), y.end(), [&dre,&u]() { return u(dre); });
+	t.assign(y.data(), 20);
+	for (size_t n = 0; n <= 20; ++n)
+		ensure (fabs(t[n] - Bell<>(n, y.data())) <= 1e-13*(1 + fabs(t[n])));
+	double b11 = t[11];
+	t.truncate(10);
+	ensure (t.size() == 10);
+	ensure (t.push(y[10]) == b11);
+	try {
+		t.assign(y.data(), 21);
+		ensure (false);
+	}
+	catch (const std::length_error&) {
+	}
+
+	// caller owned storage
+	vector<double> s(poly::bell_table<>::storage(5));
+	poly::bell_table<> u5(5, s.data());
+	ensure (u5.assign(iota(1.), 4) == Bell<>(4, iota(1)));
+
+	// partial Bell polynomials at 1 are Stirling numbers of the second kind
+	poly::bell_triangle<> S(8, x.data());
+	ensure (S(0, 0) == 1 && S(3, 0) == 0);
+	ensure (S(4, 2) == 7 && S(5, 3) == 25 && S(8, 4) == 1701);
+	for (size_t n = 0; n <= 8; ++n) {
+		double b = 0;
+		for (size_t k = 0; k <= n; ++k)
+			b += S(n, k);
+		ensure (b == Bell<>(n, x.data()));
+	}
+	// B(4, 2) = 4 x1 x3 + 3 x2^2
+	poly::bell_triangle<> T(4, iota(1.));
+	ensure (T(4, 2) == 4*1*3 + 3*2*2);
+	ensure (T(4, 1) == 4 && T(4, 4) == 1);
+
+	// f(y) = y^2, g(x) = e^x, (f o g)^(n) = 2^n e^{2x}
+	double e = exp(0.3), f[7] = {e*e, 2*e, 2, 0, 0, 0, 0}, g[7];
+	std::fill(g, g + 7, e);
+	auto h = poly::faa_di_bruno(6, f, g);
+	for (size_t n = 0; n <= 6; ++n)
+		ensure (fabs(h[n] - ldexp(e*e, (int)n)) <= 1e-14*h[n]);
+	// f(y) = e^y, g(x) = 2x, (f o g)^(n) = 2^n e^{2x}
+	double f2[7], g2[7] = {0.6, 2, 0, 0, 0, 0, 0};
+	std::fill(f2, f2 + 7, e*e);
+	auto h2 = poly::faa_di_bruno(6, f2, g2);
+	for (size_t n = 0; n <= 6; ++n)
+		ensure (h2[n] == ldexp(e*e, (int)n));
 }
 
 #endif // _DEBUG
@@ -0,0 +1,162 @@
+// bench.cpp - time polynomial evaluation
+// ./bench [--csv] [--quick] [name ...], times are per evaluation
+#include <cstdio>
+#include <mutex>
+#include <vector>
+#include "include/bench.h"
+#include "poly.h"
+
+using bench::keep;
+using bench::report;
+
+int main(int argc, char* argv[])
+{
+	bench::init(argc, argv);
+
+	// degree 10 at one point
+	double a[] = {1, -0.5, 1./6, -1./24, 1./120, -1./720, 1./5040, -1./40320, 1./362880, -1./3628800, 1./39916800};
+	const size_t n = sizeof(a)/sizeof(*a);
+	double x = 0.7;
+	report("horner loop 10", [&]() {
+		double p = a[n - 1];
+		for (size_t k = n - 1; k--; )
+			p = p*x + a[k];
+		keep(p);
+	});
+	report("poly::horner 10", [&]() { keep(poly::horner(iter::ce(a, n), x)); });
+	report("poly::nomial 10", [&]() { keep(poly::nomial(iter::ce(a, n), x)); });
+
+	// degree 10 to 40 over many points, per point
+	const size_t nx = 4096;
+	std::vector<double> px(nx), py(nx), pc(41);
+	for (size_t i = 0; i < nx; ++i)
+		px[i] = -1 + 2.*i/nx;
+	for (size_t j = 0; j < pc.size(); ++j)
+		pc[j] = 1./(j + 1);
+	for (size_t m : {11, 21, 41}) {
+		char name[48];
+		const double* c = pc.data();
+		snprintf(name, sizeof(name), "poly::horner(ce) deg %zu", m - 1);
+		report(name, [&,c,m]() { for (size_t i = 0; i < nx; ++i) py[i] = poly::horner(iter::ce(c, m), px[i]); keep(py[0]); }, nx);
+		snprintf(name, sizeof(name), "poly::nomial(ce) deg %zu", m - 1);
+		report(name, [&,c,m]() { for (size_t i = 0; i < nx; ++i) py[i] = poly::nomial(iter::ce(c, m), px[i]); keep(py[0]); }, nx);
+		snprintf(name, sizeof(name), "poly::horner(c, n, x) deg %zu", m - 1);
+		report(name, [&,c,m]() { for (size_t i = 0; i < nx; ++i) py[i] = poly::horner(c, m, px[i]); keep(py[0]); }, nx);
+		snprintf(name, sizeof(name), "poly::estrin(c, n, x) deg %zu", m - 1);
+		report(name, [&,c,m]() { for (size_t i = 0; i < nx; ++i) py[i] = poly::estrin(c, m, px[i]); keep(py[0]); }, nx);
+		snprintf(name, sizeof(name), "poly::horner batch deg %zu", m - 1);
+		report(name, [&,c,m]() { poly::horner(c, m, px.data(), py.data(), nx); keep(py[0]); }, nx);
+		snprintf(name, sizeof(name), "poly::estrin batch deg %zu", m - 1);
+		report(name, [&,c,m]() { poly::estrin(c, m, px.data(), py.data(), nx); keep(py[0]); }, nx);
+	}
+	// degree 10 with coefficients fixed at compile time
+	{
+		constexpr poly::poly_<double,11> P(1, 1., 1./2, 1./6, 1./24, 1./120, 1./720, 1./5040, 1./40320, 1./362880, 1./3628800);
+		report("poly_ horner deg 10", [&]() { for (size_t i = 0; i < nx; ++i) py[i] = P(px[i]); keep(py[0]); }, nx);
+		report("poly_ estrin deg 10", [&]() { for (size_t i = 0; i < nx; ++i) py[i] = P.estrin(px[i]); keep(py[0]); }, nx);
+		report("poly_ horner batch deg 10", [&]() { P(px.data(), py.data(), nx); keep(py[0]); }, nx);
+		report("poly_ estrin batch deg 10", [&]() { P.eval<poly::scheme::estrin>(px.data(), py.data(), nx); keep(py[0]); }, nx);
+	}
+
+	// 4 polynomials of degree 20 at one point, per polynomial
+	{
+		typedef iter::simd<double,4> X4;
+		X4 c4[21]; // std::vector does not align X4 before C++17
+		for (size_t j = 0; j < 21; ++j)
+			for (size_t l = 0; l < 4; ++l)
+				c4[j][l] = pc[j]*(l + 1);
+		std::vector<double> c1(4*21);
+		for (size_t l = 0; l < 4; ++l)
+			for (size_t j = 0; j < 21; ++j)
+				c1[21*l + j] = c4[j][l];
+		report("poly::horner 4 polynomials", [&]() { for (size_t l = 0; l < 4; ++l) keep(poly::horner(&c1[21*l], 21, x)); }, 4);
+		report("poly::horner 4 in lanes", [&]() { keep(poly::horner(c4, 21, x)); }, 4);
+		report("poly::estrin 4 in lanes", [&]() { keep(poly::estrin(c4, 21, x)); }, 4);
+	}
+
+	// complete Bell polynomials
+	std::vector<double> k(31, 0.1);
+	for (size_t m : {5, 10, 20, 30}) {
+		char name[32];
+		snprintf(name, sizeof(name), "poly::Bell %zu", m);
+		report(name, [&k,m]() { keep(poly::Bell(m, iter::ce(k.data(), k.size()))); });
+	}
+	poly::bell_table<> bt(30);
+	for (size_t m : {5, 10, 20, 30}) {
+		char name[40];
+		snprintf(name, sizeof(name), "bell_table assign %zu", m);
+		report(name, [&bt,&k,m]() { keep(bt.assign(k.data(), m)); });
+		// one new cumulant extends order m - 1 to m
+		bt.assign(k.data(), m);
+		snprintf(name, sizeof(name), "bell_table push %zu", m);
+		report(name, [&bt,&k,m]() { bt.truncate(m - 1); keep(bt.push(k[m - 1])); });
+	}
+
+	// partial Bell triangle and Faa di Bruno
+	for (size_t m : {6, 10, 20, 30}) {
+		char name[40];
+		std::vector<double> B((m + 1)*(m + 2)/2), f(m + 1, 0.5), h(m + 1);
+		snprintf(name, sizeof(name), "poly::partial_bell %zu", m);
+		report(name, [&B,&k,m]() { poly::partial_bell(m, k.data(), B.data()); keep(B.back()); });
+		snprintf(name, sizeof(name), "poly::faa_di_bruno %zu", m);
+		report(name, [&B,&f,&h,&k,m]() { poly::faa_di_bruno(m, f.data(), k.data(), h.data(), B.data()); keep(h.back()); });
+	}
+
+	// Hermite polynomials
+	for (size_t m : {5, 10, 15}) {
+		char name[32];
+		snprintf(name, sizeof(name), "poly::Hermite %zu", m);
+		report(name, [&x,m]() { keep(poly::Hermite(m)(x)); });
+		snprintf(name, sizeof(name), "poly::Hermite(%zu, x)", m);
+		report(name, [&x,m]() { keep(poly::Hermite(m, x)); });
+		snprintf(name, sizeof(name), "poly::H %zu", m);
+		report(name, [&x,m]() { keep(poly::H(m)(x)); });
+	}
+
+	// H_20 over 1M points
+	const size_t np = 1000000;
+	std::vector<double> xs(np), ys(np);
+	for (size_t i = 0; i < np; ++i)
+		xs[i] = -4 + 8.*i/np;
+	report("poly::Hermite(20)(x) 1M", [&]() { auto h = poly::Hermite(20); for (size_t i = 0; i < np; ++i) ys[i] = h(xs[i]); keep(ys[0]); }, np);
+	report("poly::Hermite(20, x) 1M", [&]() { for (size_t i = 0; i < np; ++i) ys[i] = poly::Hermite(20, xs[i]); keep(ys[0]); }, np);
+	report("poly::Hermite(20, xs, ys) 1M", [&]() { poly::Hermite(20, xs.data(), ys.data(), np); keep(ys[0]); }, np);
+	double h[21];
+	report("poly::Hermite(20, x, h)", [&]() { poly::Hermite(20, x, h); keep(h[20]); });
+
+	// shared coefficient table read by many threads, against reads under a lock
+	auto& ht = poly::hermite_coefficients();
+	std::mutex hm;
+	const size_t nt = 10000;
+	report("hermite_table row", [&ht]() { for (size_t i = 0; i < nt; ++i) keep(ht.row(i%21)); }, nt);
+	report("hermite_table(n, x)", [&ht,&x]() { for (size_t i = 0; i < nt; ++i) keep(ht(i%21, x)); }, nt);
+	for (size_t t : {1, 2, 4, 8, 16}) {
+		char name[48];
+		snprintf(name, sizeof(name), "hermite_table(n, x) %zut", t);
+		bench::report_threads(name, t, [&]() { for (size_t i = 0; i < nt; ++i) keep(ht(i%21, x)); }, nt);
+		snprintf(name, sizeof(name), "locked hermite_table(n, x) %zut", t);
+		bench::report_threads(name, t, [&]() { for (size_t i = 0; i < nt; ++i) { std::lock_guard<std::mutex> lock(hm); keep(ht(i%21, x)); } }, nt);
+	}
+
+	// products of dense polynomials, schoolbook against Karatsuba, per product
+	std::vector<double> ma(1001), mb(1001), mr(2001);
+	for (size_t j = 0; j < ma.size(); ++j) {
+		ma[j] = 1./(j + 1);
+		mb[j] = 1 - 1./(j + 2);
+	}
+	for (size_t m : {33, 101, 1001}) {
+		char name[48];
+		snprintf(name, sizeof(name), "schoolbook deg %zu", m - 1);
+		report(name, [&,m]() { poly::detail::schoolbook(ma.data(), m, mb.data(), m, mr.data()); keep(mr[m]); });
+		snprintf(name, sizeof(name), "polynomial::operator* deg %zu", m - 1);
+		poly::polynomial<> pa(iter::ce(ma.data(), m), m), pb(iter::ce(mb.data(), m), m);
+		report(name, [&pa,&pb]() { keep((pa*pb)[1]); });
+	}
+	{
+		poly::polynomial<> p(iter::ce(ma.data(), 21), 21), q{0.5, 0.25, 0.125};
+		report("polynomial::compose deg 20 by 2", [&p,&q]() { keep(p.compose(q)[1]); });
+		report("polynomial::derivative deg 20", [&p]() { keep(p.derivative()[1]); });
+	}
+
+	return 0;
+}
@@ -0,0 +1,27 @@
+// codegen.cpp - poly_ compiles to the same instructions as unrolled expressions
+// make codegen [CODEGEN=-mfma] compares the assembly of each pair of functions
+#include "horner.h"
+
+using poly::detail::madd;
+
+constexpr poly::poly_<double,5> P(1, 1./2, 1./6, 1./24, 1./120);
+
+extern "C" double poly_horner(double x)
+{
+	return P(x);
+}
+extern "C" double hand_horner(double x)
+{
+	return madd(madd(madd(madd(1./120, x, 1./24), x, 1./6), x, 1./2), x, 1.);
+}
+
+extern "C" double poly_estrin(double x)
+{
+	return P.estrin(x);
+}
+extern "C" double hand_estrin(double x)
+{
+	double x2 = x*x, x4 = x2*x2;
+
+	return madd(1./120, x4, madd(madd(1./24, x, 1./6), x2, madd(1./2, x, 1.)));
+}
@@ -1,5 +1,14 @@
 // horner.h - Evaluate polynomial using Horner method
+// horner(c, n, x) and estrin(c, n, x) evaluate c[0] + c[1] x + ... + c[n-1] x^{n-1}
+// from contiguous coefficients. Horner is one chain of n multiply adds, Estrin
+// evaluates blocks of 8 coefficients in parallel and joins them by Horner in x^8.
+// Both use fused multiply add for float and double when ITER_FMA is defined.
+// horner(c, n, x, y, m) sets y[i] = p(x[i]) for i < m using vector lanes.
+// Coefficients of type iter::simd<X,N> evaluate N polynomials at one x.
 #pragma once
+#include <cmath>
+#include <type_traits>
+#include <utility>
 #include "iter/iter.h"
 
 namespace poly {
@@ -7,20 +16,394 @@ namespace poly {
 	template<class C, class X = typename std::iterator_traits<C>::value_type>
 	inline X horner(C c, const X& x)
 	{
-		return back(accumulate([x](const X& a, const X& b) { return a*x + b; }, rend(c), X(0)));
+		return iter::back(iter::accumulate([x](const X& a, const X& b) { return a*x + b; }, iter::rend(c), X(0)));
 	}
 
+	namespace detail {
+
+		// a*b + c, one rounding if the target has fused multiply add
+#ifdef ITER_FMA
+		template<class X>
+		constexpr X fused(const X& a, const X& b, const X& c)
+		{
+			return a*b + c;
+		}
+		ITER_CONSTEXPR_KERNEL double fused(double a, double b, double c)
+		{
+			return ITER_CONSTANT_EVALUATED() ? a*b + c : std::fma(a, b, c);
+		}
+		ITER_CONSTEXPR_KERNEL float fused(float a, float b, float c)
+		{
+			return ITER_CONSTANT_EVALUATED() ? a*b + c : std::fma(a, b, c);
+		}
+		// lanes agree with the scalar result
+		template<class T, size_t N>
+		inline iter::simd<T,N> fused(iter::simd<T,N> a, const iter::simd<T,N>& b, const iter::simd<T,N>& c)
+		{
+			for (size_t k = 0; k < N; ++k)
+				a[k] = fused(a[k], b[k], c[k]);
+
+			return a;
+		}
+#if defined(__GNUC__)
+		// lanes in one register
+#define POLY_FUSED(T, N, V, F) \
+		inline iter::simd<T,N> fused(iter::simd<T,N> a, const iter::simd<T,N>& b, const iter::simd<T,N>& c) \
+		{ \
+			a.v = (typename iter::simd<T,N>::lanes)F((V)a.v, (V)b.v, (V)c.v); \
+			return a; \
+		}
+		POLY_FUSED(double, 2, __m128d, _mm_fmadd_pd)
+		POLY_FUSED(double, 4, __m256d, _mm256_fmadd_pd)
+		POLY_FUSED(float, 4, __m128, _mm_fmadd_ps)
+		POLY_FUSED(float, 8, __m256, _mm256_fmadd_ps)
+#ifdef ITER_AVX512
+		POLY_FUSED(double, 8, __m512d, _mm512_fmadd_pd)
+		POLY_FUSED(float, 16, __m512, _mm512_fmadd_ps)
+#endif
+#undef POLY_FUSED
+#endif
+		template<class A, class B, class C>
+		constexpr auto madd(const A& a, const B& b, const C& c)
+		{
+			typedef typename std::decay<decltype(a*b + c)>::type Y;
+
+			return fused(Y(a), Y(b), Y(c));
+		}
+#else
+		template<class A, class B, class C>
+		constexpr auto madd(const A& a, const B& b, const C& c)
+		{
+			return a*b + c;
+		}
+#endif
+
+	} // detail
+
+	// multiply add policies for poly_
+	// fused is detail::madd, unfused is a*b + c and is a constant expression
+	// also on compilers without __builtin_is_constant_evaluated
+	struct fused {
+		template<class A, class B, class C>
+		constexpr auto operator()(const A& a, const B& b, const C& c) const
+		{
+			return detail::madd(a, b, c);
+		}
+	};
+	struct unfused {
+		template<class A, class B, class C>
+		constexpr auto operator()(const A& a, const B& b, const C& c) const
+		{
+			return a*b + c;
+		}
+	};
+
+	namespace scheme {
+
+		// type of c*x
+		template<class C, class X>
+		using value_t = typename std::decay<decltype(std::declval<C>()*std::declval<X>())>::type;
+
+		// y[j] = p(x[j]) for j < M with the M evaluations interleaved
+		struct horner {
+			template<size_t M, class C, class X>
+			static void eval(const C* c, size_t n, const X* x, value_t<C,X>* y)
+			{
+				typedef value_t<C,X> Y;
+
+				for (size_t j = 0; j < M; ++j)
+					y[j] = n ? Y(c[n - 1]) : Y(0);
+				for (size_t k = n ? n - 1 : 0; k--; )
+					for (size_t j = 0; j < M; ++j)
+						y[j] = detail::madd(y[j], x[j], c[k]);
+			}
+			template<class C, class X>
+			static value_t<C,X> eval(const C* c, size_t n, const X& x)
+			{
+				value_t<C,X> y;
+
+				eval<1>(c, n, &x, &y);
+
+				return y;
+			}
+		};
+
+		struct estrin {
+			template<size_t M, class C, class X>
+			static void eval(const C* c, size_t n, const X* x, value_t<C,X>* y)
+			{
+				using detail::madd;
+				typedef value_t<C,X> Y;
+
+				if (n < 8)
+					return horner::eval<M>(c, n, x, y);
+
+				X x2[M], x4[M], x8[M];
+				for (size_t j = 0; j < M; ++j) {
+					x2[j] = x[j]*x[j];
+					x4[j] = x2[j]*x2[j];
+					x8[j] = x4[j]*x4[j];
+				}
+
+				// leftover high coefficients first, then blocks c[k], ..., c[k + 7]
+				size_t k = n - n%8;
+				horner::eval<M>(c + k, n%8, x, y);
+				do {
+					k -= 8;
+					const C* b = c + k;
+					for (size_t j = 0; j < M; ++j) {
+						Y b01 = madd(b[1], x[j], b[0]), b23 = madd(b[3], x[j], b[2]);
+						Y b45 = madd(b[5], x[j], b[4]), b67 = madd(b[7], x[j], b[6]);
+						y[j] = madd(y[j], x8[j], madd(madd(b67, x2[j], b45), x4[j], madd(b23, x2[j], b01)));
+					}
+				} while (k);
+			}
+			template<class C, class X>
+			static value_t<C,X> eval(const C* c, size_t n, const X& x)
+			{
+				value_t<C,X> y;
+
+				eval<1>(c, n, &x, &y);
+
+				return y;
+			}
+		};
+
+	} // scheme
+
+	// c[0] + c[1] x + ... + c[n-1] x^{n-1}
+	template<class S = scheme::horner, class C, class X>
+	inline auto eval(const C* c, size_t n, const X& x)
+	{
+		return S::eval(c, n, x);
+	}
+	// y[i] = eval(c, n, x[i]) for i < m
+	template<class S = scheme::horner, class X>
+	inline void eval(const X* c, size_t n, const X* x, X* y, size_t m)
+	{
+		static const size_t N = iter::detail::simd_bytes ? iter::detail::simd_bytes/sizeof(X) : 2;
+		typedef iter::simd<X,N> XN;
+
+		// two registers of independent points
+		size_t i = 0;
+		for (; m - i >= 2*N; i += 2*N) {
+			XN x_[2] = {XN::load(x + i), XN::load(x + i + N)}, y_[2];
+			S::template eval<2>(c, n, x_, y_);
+			y_[0].store(y + i);
+			y_[1].store(y + i + N);
+		}
+		for (m -= i; m--; )
+			y[i + m] = S::eval(c, n, x[i + m]);
+	}
+
+	template<class C, class X>
+	inline auto horner(const C* c, size_t n, const X& x)
+	{
+		return eval<scheme::horner>(c, n, x);
+	}
+	template<class X>
+	inline void horner(const X* c, size_t n, const X* x, X* y, size_t m)
+	{
+		eval<scheme::horner>(c, n, x, y, m);
+	}
+	template<class C, class X>
+	inline auto estrin(const C* c, size_t n, const X& x)
+	{
+		return eval<scheme::estrin>(c, n, x);
+	}
+	template<class X>
+	inline void estrin(const X* c, size_t n, const X* x, X* y, size_t m)
+	{
+		eval<scheme::estrin>(c, n, x, y, m);
+	}
+
+	// c[0] + c[1] x + ... + c[N-1] x^{N-1} with fixed coefficients
+	// poly_<double,3> p(1., 2., 3.); p(x), p.estrin(x), p(x, y, m), p.eval<scheme::estrin>(x, y, m)
+	// Evaluation is unrolled at compile time.
+	template<class X, size_t N>
+	class poly_ {
+		static_assert(N > 0, "poly::poly_: no coefficients");
+		X c[N];
+
+		template<size_t K>
+		using index = std::integral_constant<size_t,K>;
+
+		// largest power of 2 less than n > 1, and log base 2 of a power of 2
+		static constexpr size_t half(size_t n)
+		{
+			return n <= 2 ? 1 : 2*half((n + 1)/2);
+		}
+		static constexpr size_t lg(size_t m)
+		{
+			return m == 1 ? 0 : 1 + lg(m/2);
+		}
+
+		// c[K] + x(c[K+1] + x(... + x c[N-1]))
+		template<class F, class Y>
+		constexpr Y horner_(const Y& x, index<N - 1>) const
+		{
+			return Y(c[N - 1]);
+		}
+		template<class F, class Y, size_t K>
+		constexpr Y horner_(const Y& x, index<K>) const
+		{
+			return F{}(horner_<F>(x, index<K + 1>{}), x, Y(c[K]));
+		}
+		// c[B] + ... + c[B + L - 1] x^{L - 1} with x^{2^j} in p[j]
+		template<class F, size_t B, class Y>
+		constexpr Y estrin_(const Y*, index<1>) const
+		{
+			return Y(c[B]);
+		}
+		template<class F, size_t B, class Y, size_t L>
+		constexpr Y estrin_(const Y* p, index<L>) const
+		{
+			return F{}(estrin_<F, B + half(L)>(p, index<L - half(L)>{}), p[lg(half(L))], estrin_<F, B>(p, index<half(L)>{}));
+		}
+
+		template<class Y>
+		constexpr Y eval_(const Y& x, scheme::horner) const
+		{
+			return horner(x);
+		}
+		template<class Y>
+		constexpr Y eval_(const Y& x, scheme::estrin) const
+		{
+			return estrin(x);
+		}
+	public:
+		template<class... C>
+		constexpr poly_(C... c)
+			: c{X(c)...}
+		{
+			static_assert(sizeof...(C) == N, "poly::poly_: wrong number of coefficients");
+		}
+
+		static constexpr size_t size()
+		{
+			return N;
+		}
+		constexpr const X& operator[](size_t k) const
+		{
+			return c[k];
+		}
+
+		// p.horner<unfused>(x) in constant expressions on any compiler
+		template<class F = fused, class Y>
+		constexpr Y horner(const Y& x) const
+		{
+			return horner_<F>(x, index<0>{});
+		}
+		template<class F = fused, class Y>
+		constexpr Y estrin(const Y& x) const
+		{
+			Y p[lg(N > 1 ? half(N) : 1) + 1] = {x};
+			for (size_t j = 1; j < sizeof(p)/sizeof(*p); ++j)
+				p[j] = p[j - 1]*p[j - 1];
+
+			return estrin_<F, 0>(p, index<N>{});
+		}
+		template<class Y>
+		constexpr Y operator()(const Y& x) const
+		{
+			return horner(x);
+		}
+		// y[i] = p(x[i]) for i < m
+		template<class S = scheme::horner>
+		void eval(const X* x, X* y, size_t m) const
+		{
+			static const size_t M = iter::detail::simd_bytes ? iter::detail::simd_bytes/sizeof(X) : 2;
+			typedef iter::simd<X,M> XM;
+
+			size_t i = 0;
+			for (; m - i >= 2*M; i += 2*M) {
+				XM y0 = eval_(XM::load(x + i), S{}), y1 = eval_(XM::load(x + i + M), S{});
+				y0.store(y + i);
+				y1.store(y + i + M);
+			}
+			for (m -= i; m--; )
+				y[i + m] = eval_(x[i + m], S{});
+		}
+		void operator()(const X* x, X* y, size_t m) const
+		{
+			eval(x, y, m);
+		}
+	};
+
 } // poly
 
 #ifdef _DEBUG
+#include <cmath>
 #include "include/ensure.h"
+#include "nomial.h"
 
 inline void test_horner()
 {
 	int c[] = {1,2,3};
 
 	ensure (poly::horner(ce(c), 4) == poly::nomial(ce(c), 4));
-}
+	ensure (poly::horner(c, 3, 4) == poly::nomial(ce(c), 4));
+	ensure (poly::estrin(c, 3, 4) == poly::nomial(ce(c), 4));
+	ensure (poly::horner(c, 0, 4) == 0);
+
+	// integer coefficients and points are exact in every scheme
+	double d[41];
+	for (size_t k = 0; k < 41; ++k)
+		d[k] = (k%3) - 1.;
+	for (size_t n : {1, 7, 8, 9, 16, 17, 23, 41}) {
+		for (double x : {-1., 0., 1., 2.}) {
+			double p = poly::horner(d, n, x);
+			ensure (p == poly::nomial(ce(d, n), x));
+			ensure (p == poly::estrin(d, n, x));
+		}
+	}
 
+	// batch agrees with one point at a time
+	double x[37], y[37], z[37];
+	for (size_t i = 0; i < 37; ++i)
+		x[i] = -1 + i/18.;
+	for (size_t n : {0, 1, 11, 41}) {
+		poly::horner(d, n, x, y, 37);
+		poly::estrin(d, n, x, z, 37);
+		for (size_t i = 0; i < 37; ++i) {
+			ensure (y[i] == poly::horner(d, n, x[i]));
+			ensure (z[i] == poly::estrin(d, n, x[i]));
+			ensure (std::fabs(y[i] - z[i]) <= 1e-13);
+		}
+	}
+
+	// 1 + x + x^2, 1 - x + x^2 in lanes
+	typedef iter::simd<double,2> X2;
+	X2 e[3];
+	e[0] = X2(1);
+	e[1][0] = 1;
+	e[1][1] = -1;
+	e[2] = X2(1);
+	X2 p = poly::horner(e, 3, 2.);
+	ensure (p[0] == 7 && p[1] == 3);
+	p = poly::estrin(e, 3, 2.);
+	ensure (p[0] == 7 && p[1] == 3);
+
+	// fixed coefficients agree with the runtime schemes
+	constexpr poly::poly_<double,11> f(1, -1, 0, 1, 0, -1, 1, -1, 0, 1, 0);
+	static_assert(f.size() == 11 && f[3] == 1, "poly_");
+	for (size_t i = 0; i < 37; ++i) {
+		double d_[11];
+		for (size_t k = 0; k < 11; ++k)
+			d_[k] = f[k];
+		ensure (f(x[i]) == poly::horner(d_, 11, x[i]));
+		ensure (std::fabs(f.estrin(x[i]) - f(x[i])) <= 1e-14);
+	}
+	f(x, y, 37);
+	f.eval<poly::scheme::estrin>(x, z, 37);
+	for (size_t i = 0; i < 37; ++i) {
+		ensure (y[i] == f(x[i]));
+		ensure (z[i] == f.estrin(x[i]));
+	}
+	constexpr poly::poly_<double,1> g(3);
+	ensure (g(2.) == 3 && g.estrin(2.) == 3);
+	p = f(X2::load(x));
+	ensure (p[0] == f(x[0]) && p[1] == f(x[1]));
+}
 
-#endif // _DEBUG
\ No newline at end of file
+#endif // _DEBUG
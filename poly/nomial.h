@@ -8,23 +8,9 @@ namespace poly {
 	template<class C, class X = typename std::iterator_traits<C>::value_type>
 	inline X nomial(C c, const X& x)
 	{
-		return sum0(c*pow(x));
+		return iter::sum0(c*iter::pow(x));
 	}
-/*
-	template<class X, size_t N, class C = X>
-	struct poly_ {
-		template<C c0, C... c_>
-		X nomial(const X& x)
-		{
-			return c0 + x*nomial<c_...>(x);
-		}
-		template<C c0>
-		X nomial(const X& x)
-		{
-			return c0;
-		}
-	};
-*/
+
 } // poly
 
 #ifdef _DEBUG
@@ -34,6 +20,10 @@ inline void test_nomial()
 {
 	int a[] = {1,2,3};
 	ensure (poly::nomial(ce(a), 4) == 1 + 2*4 + 3*4*4);
+
+	double x[] = {4, -1};
+	auto y = poly::nomial(ce(a), iter::simd<double,2>::load(x));
+	ensure (y[0] == 1 + 2*4 + 3*4*4 && y[1] == 1 - 2 + 3);
 }
 
 
@@ -1,5 +1,6 @@
 // poly.cpp - test polynomial functions
 #include "poly.h"
+#include "static_test.h"
 
 int main()
 {
@@ -8,6 +9,7 @@ int main()
 		test_hermite();
 		test_horner();
 		test_nomial();
+		test_polynomial();
 	}
 	catch (...) {
 		return -1;
@@ -0,0 +1,349 @@
+// polynomial.h - dense polynomials with contiguous coefficients
+// polynomial<X> p{c0, c1, ...} is c0 + c1 x + ... and has arithmetic,
+// derivative, antiderivative, and composition. Products switch from the
+// schoolbook method to Karatsuba when both factors have more than
+// POLY_KARATSUBA coefficients. p.coefficients() is a counted enumerator
+// for nomial and horner.
+#pragma once
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include "iter/iter.h"
+#include "horner.h"
+
+// smallest factor multiplied by Karatsuba
+#ifndef POLY_KARATSUBA
+#define POLY_KARATSUBA 32
+#endif
+
+namespace poly {
+
+	namespace detail {
+
+		// r[0, n + m - 1) = a[0, n) b[0, m), r is not initialized
+		template<class X>
+		inline void schoolbook(const X* a, size_t n, const X* b, size_t m, X* r)
+		{
+			std::fill(r, r + n + m - 1, X(0));
+			for (size_t i = 0; i < n; ++i) {
+				X ai = a[i];
+				X* ri = r + i; // contiguous inner loop
+				for (size_t j = 0; j < m; ++j)
+					ri[j] += ai*b[j];
+			}
+		}
+
+		// scratch needed by karatsuba for n coefficients
+		inline size_t karatsuba_scratch(size_t n)
+		{
+			return n <= POLY_KARATSUBA ? 0 : 4*(n - n/2) - 1 + karatsuba_scratch(n - n/2);
+		}
+		// r[0, 2n - 1) = a[0, n) b[0, n) using scratch t
+		// (a0 + a1 x^h)(b0 + b1 x^h) = z0 + ((a0 + a1)(b0 + b1) - z0 - z2) x^h + z2 x^2h
+		template<class X>
+		inline void karatsuba(const X* a, const X* b, size_t n, X* r, X* t)
+		{
+			if (n <= POLY_KARATSUBA)
+				return schoolbook(a, n, b, n, r);
+
+			size_t h = n/2, l = n - h; // l >= h
+			karatsuba(a, b, h, r, t); // z0
+			r[2*h - 1] = X(0);
+			karatsuba(a + h, b + h, l, r + 2*h, t); // z2
+
+			X* sa = t;
+			X* sb = sa + l;
+			X* z1 = sb + l;
+			for (size_t i = 0; i < l; ++i) {
+				sa[i] = a[h + i] + (i < h ? a[i] : X(0));
+				sb[i] = b[h + i] + (i < h ? b[i] : X(0));
+			}
+			karatsuba(sa, sb, l, z1, z1 + 2*l - 1);
+			for (size_t i = 0; i < 2*h - 1; ++i)
+				z1[i] -= r[i];
+			for (size_t i = 0; i < 2*l - 1; ++i)
+				z1[i] -= r[2*h + i];
+			for (size_t i = 0; i < 2*l - 1; ++i)
+				r[h + i] += z1[i];
+		}
+
+		// r[0, n + m - 1) = a[0, n) b[0, m), r is not initialized
+		template<class X>
+		inline void multiply(const X* a, size_t n, const X* b, size_t m, X* r)
+		{
+			if (n < m) {
+				std::swap(a, b);
+				std::swap(n, m);
+			}
+			if (m <= POLY_KARATSUBA)
+				return schoolbook(a, n, b, m, r);
+
+			// blocks of a the size of b
+			std::vector<X> t(karatsuba_scratch(m) + 2*m - 1);
+			X* p = t.data() + karatsuba_scratch(m);
+			std::fill(r, r + n + m - 1, X(0));
+			for (size_t k = 0; k < n; k += m) {
+				size_t nk = std::min(m, n - k);
+				if (nk == m)
+					karatsuba(a + k, b, m, p, t.data());
+				else
+					multiply(a + k, nk, b, m, p);
+				for (size_t i = 0; i < nk + m - 1; ++i)
+					r[k + i] += p[i];
+			}
+		}
+
+	} // detail
+
+	template<class X = double>
+	class polynomial {
+		std::vector<X> c; // never empty
+
+		// drop high zero coefficients
+		polynomial& trim()
+		{
+			while (c.size() > 1 && c.back() == X(0))
+				c.pop_back();
+
+			return *this;
+		}
+	public:
+		typedef X value_type;
+
+		// the zero polynomial
+		polynomial()
+			: c(1, X(0))
+		{ }
+		polynomial(std::initializer_list<X> c)
+			: c(c)
+		{
+			if (this->c.empty())
+				this->c.push_back(X(0));
+			trim();
+		}
+		explicit polynomial(std::vector<X> c)
+			: c(std::move(c))
+		{
+			if (this->c.empty())
+				this->c.push_back(X(0));
+			trim();
+		}
+		// first n values of an enumerator
+		template<class E>
+		polynomial(E e, size_t n)
+			: c(n ? n : 1, X(0))
+		{
+			for (size_t k = 0; k < n && e; ++k, ++e)
+				c[k] = *e;
+			trim();
+		}
+
+		// the zero polynomial has degree 0
+		size_t degree() const
+		{
+			return c.size() - 1;
+		}
+		size_t size() const
+		{
+			return c.size();
+		}
+		const X* data() const
+		{
+			return c.data();
+		}
+		// coefficient of x^k, 0 above the degree
+		X operator[](size_t k) const
+		{
+			return k < c.size() ? c[k] : X(0);
+		}
+		auto coefficients() const
+		{
+			return iter::ce(c.data(), c.size());
+		}
+
+		template<class Y>
+		auto operator()(const Y& x) const
+		{
+			return horner(c.data(), c.size(), x);
+		}
+		// y[i] = p(x[i]) for i < m
+		template<class S = scheme::horner>
+		void eval(const X* x, X* y, size_t m) const
+		{
+			poly::eval<S>(c.data(), c.size(), x, y, m);
+		}
+
+		bool operator==(const polynomial& p) const
+		{
+			return c == p.c;
+		}
+		bool operator!=(const polynomial& p) const
+		{
+			return c != p.c;
+		}
+
+		polynomial operator-() const
+		{
+			polynomial p(*this);
+
+			for (auto& a : p.c)
+				a = -a;
+
+			return p;
+		}
+		polynomial& operator+=(const polynomial& p)
+		{
+			if (c.size() < p.c.size())
+				c.resize(p.c.size(), X(0));
+			for (size_t k = 0; k < p.c.size(); ++k)
+				c[k] += p.c[k];
+
+			return trim();
+		}
+		polynomial& operator-=(const polynomial& p)
+		{
+			if (c.size() < p.c.size())
+				c.resize(p.c.size(), X(0));
+			for (size_t k = 0; k < p.c.size(); ++k)
+				c[k] -= p.c[k];
+
+			return trim();
+		}
+		polynomial& operator*=(const X& a)
+		{
+			for (auto& b : c)
+				b *= a;
+
+			return trim();
+		}
+		polynomial& operator*=(const polynomial& p)
+		{
+			return *this = *this*p;
+		}
+
+		friend polynomial operator+(polynomial p, const polynomial& q)
+		{
+			return p += q;
+		}
+		friend polynomial operator-(polynomial p, const polynomial& q)
+		{
+			return p -= q;
+		}
+		friend polynomial operator*(const polynomial& p, const polynomial& q)
+		{
+			polynomial r;
+
+			r.c.resize(p.c.size() + q.c.size() - 1);
+			detail::multiply(p.c.data(), p.c.size(), q.c.data(), q.c.size(), r.c.data());
+
+			return r.trim();
+		}
+		friend polynomial operator*(polynomial p, const X& a)
+		{
+			return p *= a;
+		}
+		friend polynomial operator*(const X& a, polynomial p)
+		{
+			return p *= a;
+		}
+
+		// p'
+		polynomial derivative() const
+		{
+			std::vector<X> d(c.size() > 1 ? c.size() - 1 : 1, X(0));
+
+			for (size_t k = 1; k < c.size(); ++k)
+				d[k - 1] = X(k)*c[k];
+
+			return polynomial(std::move(d));
+		}
+		// P with P' = p and P(0) = a
+		polynomial antiderivative(const X& a = X(0)) const
+		{
+			std::vector<X> P(c.size() + 1);
+
+			P[0] = a;
+			for (size_t k = 0; k < c.size(); ++k)
+				P[k + 1] = c[k]/X(k + 1);
+
+			return polynomial(std::move(P));
+		}
+		// p(q(x)) by Horner's method on polynomials
+		polynomial compose(const polynomial& q) const
+		{
+			polynomial r{c.back()};
+
+			for (size_t k = c.size() - 1; k--; ) {
+				r *= q;
+				r.c[0] += c[k];
+				r.trim();
+			}
+
+			return r;
+		}
+	};
+
+} // poly
+
+#ifdef _DEBUG
+#include <cmath>
+#include <random>
+#include "include/ensure.h"
+#include "nomial.h"
+
+inline void test_polynomial()
+{
+	using poly::polynomial;
+
+	polynomial<> p{1, 2, 3}, q{-1, 1}, z;
+	ensure (p.degree() == 2 && p[2] == 3 && p[5] == 0);
+	ensure (z.degree() == 0 && z[0] == 0);
+	ensure ((polynomial<>{1, 2, 0, 0}).size() == 2);
+	ensure (p(2.) == 1 + 2*2 + 3*4);
+	ensure (p(2.) == poly::nomial(p.coefficients(), 2.));
+	ensure (p(2.) == poly::horner(p.coefficients(), 2.));
+
+	ensure (p + q == (polynomial<>{0, 3, 3}));
+	ensure (p - p == z);
+	ensure (-q == (polynomial<>{1, -1}));
+	ensure (2.*q == (polynomial<>{-2, 2}));
+	// (1 + 2x + 3x^2)(-1 + x) = -1 - x - x^2 + 3x^3
+	ensure (p*q == (polynomial<>{-1, -1, -1, 3}));
+	ensure (p*z == z);
+
+	ensure (p.derivative() == (polynomial<>{2, 6}));
+	ensure (z.derivative() == z);
+	ensure (p.antiderivative(5) == (polynomial<>{5, 1, 1, 1}));
+	ensure (p.antiderivative().derivative() == p);
+	// p(q(x)) = 1 + 2(x - 1) + 3(x - 1)^2 = 2 - 4x + 3x^2
+	ensure (p.compose(q) == (polynomial<>{2, -4, 3}));
+	for (double x : {-1., 0.5, 3.})
+		ensure (p.compose(q)(x) == p(q(x)));
+
+	ensure (polynomial<>(iter::iota(1.), 3) == (polynomial<>{1, 2, 3}));
+
+	// Karatsuba agrees with schoolbook on small integers
+	std::default_random_engine dre;
+	std::uniform_int_distribution<int> u(-9, 9);
+	for (size_t n : {1, 31, 33, 64, 100, 257}) {
+		for (size_t m : {1, 33, 70, 257}) {
+			std::vector<double> a(n), b(m), r(n + m - 1), s(n + m - 1);
+			for (auto& x : a)
+				x = u(dre);
+			for (auto& x : b)
+				x = u(dre);
+			poly::detail::multiply(a.data(), n, b.data(), m, r.data());
+			poly::detail::schoolbook(a.data(), n, b.data(), m, s.data());
+			ensure (r == s);
+		}
+	}
+
+	// batch evaluation
+	double x[5] = {-2, -1, 0, 1, 2}, y[5];
+	p.eval(x, y, 5);
+	for (size_t i = 0; i < 5; ++i)
+		ensure (y[i] == p(x[i]));
+}
+
+#endif // _DEBUG
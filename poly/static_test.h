@@ -0,0 +1,45 @@
+// static_test.h - values computed at compile time
+#pragma once
+#include "iter/iter.h"
+#include "bell.h"
+#include "horner.h"
+
+namespace poly {
+
+	namespace static_test {
+
+		using namespace iter;
+
+		// http://en.wikipedia.org/wiki/Bell_number
+		constexpr auto B = Bells<9>(c(1.));
+		static_assert(B[0] == 1 && B[1] == 1 && B[2] == 2 && B[3] == 5 && B[4] == 15, "Bell numbers");
+		static_assert(B[5] == 52 && B[6] == 203 && B[7] == 877 && B[8] == 4140, "Bell numbers");
+
+		// B(2,1,2) = x1^2 + x2, B(3,1,2,3) = x1^3 + 3 x1 x2 + x3
+		constexpr auto Bi = Bells<5>(iota(1.));
+		static_assert(Bi[2] == 1 + 2 && Bi[3] == 1 + 3*2 + 3, "Bell polynomials");
+		static_assert(Bi[4] == 1 + 6*2 + 4*3 + 3*2*2 + 4, "Bell polynomials");
+
+		constexpr auto F = table<21>(factorial());
+		static_assert(F[10] == 3628800 && F[20] == 2432902008176640000ULL, "factorials");
+
+		constexpr auto C = table<11>(choose(10));
+		static_assert(C[0] == 1 && C[3] == 120 && C[5] == 252 && C[10] == 1, "binomial row");
+		static_assert(step::sum0(choose(10)) == 1024, "binomial row sum");
+
+		// fixed coefficients, 1 + 2x + 3x^2 + 4x^3 + 5x^4
+		constexpr poly_<double,5> P(1, 2, 3, 4, 5);
+		static_assert(P.horner<unfused>(2.) == 1 + 2*2 + 3*4 + 4*8 + 5*16, "poly_");
+		static_assert(P.estrin<unfused>(2.) == P.horner<unfused>(2.), "poly_");
+		static_assert(P.horner<unfused>(-1.) == 3 && P.estrin<unfused>(0.5) == P.horner<unfused>(0.5), "poly_");
+#ifndef ITER_NO_CONSTANT_EVALUATED
+		static_assert(P(2.) == P.horner<unfused>(2.) && P.estrin(0.5) == P(0.5), "poly_");
+#endif
+
+		// exp(x) = sum x^n/n!
+		constexpr auto T = table<8>(c(1.)/factorial());
+		static_assert(T[0] == 1 && T[2] == 0.5 && T[3] == 1./6 && T[7] == 1./5040, "Taylor coefficients");
+
+	} // static_test
+
+} // poly
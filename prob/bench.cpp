@@ -0,0 +1,40 @@
+// bench.cpp - time the normal distribution
+// ./bench [--csv] [--quick] [name ...], times are per evaluation
+#include <cmath>
+#include <cstdio>
+#include "include/bench.h"
+#include "prob.h"
+
+using bench::keep;
+using bench::report;
+
+int main(int argc, char* argv[])
+{
+	bench::init(argc, argv);
+
+	typedef prob::normal<> N;
+
+	for (double x : {0.5, 2., 5.}) {
+		char name[32];
+		snprintf(name, sizeof(name), "std::erfc %g", x);
+		report(name, [x]() { keep(0.5*std::erfc(-x/M_SQRT2)); });
+		snprintf(name, sizeof(name), "normal::cdf %g", x);
+		report(name, [x]() { keep(N::cdf(x)); });
+		snprintf(name, sizeof(name), "normal::cdf 1e-8 %g", x);
+		report(name, [x]() { keep(N::cdf(x, iter::converge::relative(1e-8))); });
+	}
+	report("normal::pdf", []() { keep(N::pdf(0.5)); });
+	for (size_t n : {2, 4, 6, 10}) {
+		char name[32];
+		snprintf(name, sizeof(name), "normal::ddf %zu", n);
+		report(name, [n]() { keep(N::ddf(n, 0.5)); });
+	}
+
+	// calls and cycles inside instrumented regions when built with -DREGION_ENABLE
+#ifdef REGION_ENABLE
+	if (!bench::config().csv)
+		region::report();
+#endif
+
+	return 0;
+}